@@ -59,6 +59,22 @@ namespace {
 
 constexpr auto kImageAreaLimit = 12'032 * 9'024;
 
+// The image may be rotated by EXIF after decoding, so the result should
+// fit the box in any orientation without becoming smaller than needed.
+QSize ScaledDecodeSize(QSize size, QSize shrinkBox) {
+	const auto width = float64(std::max(size.width(), 1));
+	const auto height = float64(std::max(size.height(), 1));
+	const auto scale = std::max(
+		std::min(shrinkBox.width() / width, shrinkBox.height() / height),
+		std::min(shrinkBox.height() / width, shrinkBox.width() / height));
+	if (scale >= 1.) {
+		return QSize();
+	}
+	return QSize(
+		std::max(int(std::ceil(width * scale)), 1),
+		std::max(int(std::ceil(height * scale)), 1));
+}
+
 App::LaunchState _launchState = App::Launched;
 
 HistoryView::Element *hoveredItem = nullptr,
@@ -321,7 +337,7 @@ namespace App {
 		App::quit();
 	}
 
-	QImage readImage(QByteArray data, QByteArray *format, bool opaque, bool *animated) {
+	QImage readImage(QByteArray data, QByteArray *format, bool opaque, bool *animated, QSize shrinkBox) {
 		QByteArray tmpFormat;
 		QImage result;
 		QBuffer buffer(&data);
@@ -343,6 +359,13 @@ namespace App {
 			}
 			QByteArray fmt = reader.format();
 			if (!fmt.isEmpty()) *format = fmt;
+			if (!shrinkBox.isEmpty() && (fmt == "jpeg" || fmt == "jpg")) {
+				// JPEG decoder can skip DCT coefficients for a smaller size.
+				const auto scaled = ScaledDecodeSize(imageSize, shrinkBox);
+				if (!scaled.isEmpty()) {
+					reader.setScaledSize(scaled);
+				}
+			}
 			if (!reader.read(&result)) {
 				return QImage();
 			}
@@ -324,13 +324,9 @@ void LocalStorageBox::update(
 			_stats.clearing || _statsBig.clearing);
 	}
 	for (const auto &entry : _rows) {
-		if (entry.first == kFakeMediaCacheTag) {
-			updateRow(entry.second, &_statsBig.full);
-		} else if (entry.first) {
-			const auto i = _stats.tagged.find(entry.first);
-			updateRow(
-				entry.second,
-				(i != end(_stats.tagged)) ? &i->second : nullptr);
+		if (entry.first) {
+			const auto data = taggedSummary(entry.first);
+			updateRow(entry.second, &data);
 		} else {
 			const auto full = summary();
 			updateRow(entry.second, &full);
@@ -345,11 +341,49 @@ auto LocalStorageBox::summary() const -> Database::TaggedSummary {
 	return result;
 }
 
+auto LocalStorageBox::taggedSummary(uint16 tag) const
+-> Database::TaggedSummary {
+	const auto add = [](
+			Database::TaggedSummary &result,
+			const Database::Stats &stats,
+			uint8 key) {
+		const auto i = stats.tagged.find(key);
+		if (i != end(stats.tagged)) {
+			result.count += i->second.count;
+			result.totalSize += i->second.totalSize;
+		}
+	};
+	auto result = Database::TaggedSummary();
+	if (tag == kFakeMediaCacheTag) {
+		// Streamed slices are everything that is not a whole file.
+		result = _statsBig.full;
+		for (const auto &[entryTag, data] : _statsBig.tagged) {
+			if (Data::IsBigFileCacheTag(entryTag)) {
+				result.count -= data.count;
+				result.totalSize -= data.totalSize;
+			}
+		}
+	} else {
+		// Entries written before the heavy tags were moved to the big
+		// file cache can still be found in the main one.
+		const auto key = uint8(tag);
+		add(result, _stats, key);
+		if (Data::IsBigFileCacheTag(key)) {
+			add(result, _statsBig, key);
+		}
+	}
+	return result;
+}
+
 void LocalStorageBox::clearByTag(uint16 tag) {
 	if (tag == kFakeMediaCacheTag) {
-		_dbBig->clear();
+		// Streamed slices are put untagged, whole files keep their tags.
+		_dbBig->clearByTag(0);
 	} else if (tag) {
 		_db->clearByTag(tag);
+		if (Data::IsBigFileCacheTag(uint8(tag))) {
+			_dbBig->clearByTag(tag);
+		}
 	} else {
 		_db->clear();
 		_dbBig->clear();
@@ -384,9 +418,7 @@ void LocalStorageBox::setupControls() {
 	};
 	auto tracker = Ui::MultiSlideTracker();
 	const auto createTagRow = [&](uint8 tag, auto &&titleFactory) {
-		static const auto empty = Database::TaggedSummary();
-		const auto i = _stats.tagged.find(tag);
-		const auto &data = (i != end(_stats.tagged)) ? i->second : empty;
+		const auto data = taggedSummary(tag);
 		auto factory = std::forward<decltype(titleFactory)>(titleFactory);
 		auto title = [factory = std::move(factory)](size_type count) {
 			return factory(tr::now, lt_count, count);
@@ -422,7 +454,7 @@ void LocalStorageBox::setupControls() {
 		kFakeMediaCacheTag,
 		std::move(mediaCacheTitle),
 		tr::lng_local_storage_clear_some(),
-		_statsBig.full));
+		taggedSummary(kFakeMediaCacheTag)));
 	shadow->toggleOn(
 		std::move(tracker).atLeastOneShownValue()
 	);
@@ -65,6 +65,7 @@ private:
 	void save();
 
 	Database::TaggedSummary summary() const;
+	Database::TaggedSummary taggedSummary(uint16 tag) const;
 
 	template <
 		typename Value,
@@ -437,7 +437,7 @@ void PasscodeBox::handleSrpIdInvalid() {
 }
 
 void PasscodeBox::save(bool force) {
-	if (_setRequest) return;
+	if (_setRequest || _checkingPasscode) return;
 
 	QString old = _oldPasscode->text(), pwd = _newPasscode->text(), conf = _reenterPasscode->text();
 	const auto has = currentlyHave();
@@ -450,15 +450,25 @@ void PasscodeBox::save(bool force) {
 			return;
 		}
 
-		if (Local::checkPasscode(old.toUtf8())) {
-			cSetPasscodeBadTries(0);
-			if (_turningOff) pwd = conf = QString();
-		} else {
-			cSetPasscodeBadTries(cPasscodeBadTries() + 1);
-			cSetPasscodeLastTry(crl::now());
-			badOldPasscode();
+		if (_checkedPasscode != old) {
+			_checkingPasscode = true;
+			Local::checkPasscodeAsync(old.toUtf8(), crl::guard(this, [=](
+					bool correct) {
+				_checkingPasscode = false;
+				if (correct) {
+					_checkedPasscode = old;
+					save(force);
+				} else {
+					cSetPasscodeBadTries(cPasscodeBadTries() + 1);
+					cSetPasscodeLastTry(crl::now());
+					badOldPasscode();
+				}
+			}));
 			return;
 		}
+		_checkedPasscode = std::nullopt;
+		cSetPasscodeBadTries(0);
+		if (_turningOff) pwd = conf = QString();
 	}
 	const auto onlyCheck = onlyCheckCurrent();
 	if (!onlyCheck && pwd.isEmpty()) {
@@ -516,13 +526,16 @@ void PasscodeBox::save(bool force) {
 		}
 	} else {
 		closeReplacedBy();
-		const auto weak = Ui::MakeWeak(this);
 		cSetPasscodeBadTries(0);
-		Local::setPasscode(pwd.toUtf8());
-		_session->localPasscodeChanged();
-		if (weak) {
-			closeBox();
-		}
+		_checkingPasscode = true;
+		Local::setPasscodeAsync(pwd.toUtf8(), crl::guard(this, [=] {
+			_checkingPasscode = false;
+			const auto weak = Ui::MakeWeak(this);
+			_session->localPasscodeChanged();
+			if (weak) {
+				closeBox();
+			}
+		}));
 	}
 }
 
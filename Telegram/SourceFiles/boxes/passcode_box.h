@@ -139,6 +139,8 @@ private:
 	bool _cloudPwd = false;
 	CloudFields _cloudFields;
 	mtpRequestId _setRequest = 0;
+	bool _checkingPasscode = false;
+	std::optional<QString> _checkedPasscode;
 
 	crl::time _lastSrpIdInvalidTime = 0;
 	bool _skipEmailWarning = false;
@@ -364,6 +364,7 @@ bool ChatFilters::applyChange(ChatFilter &filter, ChatFilter &&updated) {
 	}
 	if (rulesChanged) {
 		const auto filterList = _owner->chatsFilters().chatsList(id);
+		const auto batch = filterList->unreadStateChangesBatch();
 		const auto feedHistory = [&](not_null<History*> history) {
 			const auto now = updated.contains(history);
 			const auto was = filter.contains(history);
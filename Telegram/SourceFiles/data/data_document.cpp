@@ -589,7 +589,7 @@ void DocumentData::validateLottieSticker() {
 void DocumentData::setDataAndCache(const QByteArray &data) {
 	setData(data);
 	if (saveToCache() && data.size() <= Storage::kMaxFileInMemory) {
-		owner().cache().put(
+		owner().cacheForTag(cacheTag()).put(
 			cacheKey(),
 			Storage::Cache::Database::TaggedValue(
 				base::duplicate(data),
@@ -1622,7 +1622,9 @@ void DocumentData::collectLocalData(not_null<DocumentData*> local) {
 		return;
 	}
 
-	_owner->cache().copyIfEmpty(local->cacheKey(), cacheKey());
+	_owner->cacheForTag(cacheTag()).copyIfEmpty(
+		local->cacheKey(),
+		cacheKey());
 	if (!local->_data.isEmpty()) {
 		ActiveCache().decrement(_data.size());
 		_data = local->_data;
@@ -62,6 +62,10 @@ namespace {
 
 constexpr auto kMaxNotifyCheckDelay = 24 * 3600 * crl::time(1000);
 constexpr auto kMaxWallpaperSize = 10 * 1024 * 1024;
+constexpr auto kHiddenSenderInfosCleanupSize = 64;
+constexpr auto kInternedNamesCleanupSize = 64;
+constexpr auto kMaxPlayingVideoFiles = 8;
+constexpr auto kPlayingVideoFileHiddenTimeout = crl::time(1000);
 
 using ViewElement = HistoryView::Element;
 
@@ -860,6 +864,10 @@ Storage::Cache::Database &Session::cacheBigFile() {
 	return *_bigFileCache;
 }
 
+Storage::Cache::Database &Session::cacheForTag(uint8 tag) {
+	return IsBigFileCacheTag(tag) ? cacheBigFile() : cache();
+}
+
 void Session::startExport(PeerData *peer) {
 	startExport(peer ? peer->input : MTP_inputPeerEmpty());
 }
@@ -1710,7 +1718,10 @@ void Session::updateEditedMessage(const MTPMessage &data) {
 void Session::processMessages(
 		const QVector<MTPMessage> &data,
 		NewMessageType type) {
-	auto indices = base::flat_map<uint64, int>();
+	// Sort once instead of inserting into a flat_map one by one,
+	// differences after a long offline period have thousands of messages.
+	auto positions = std::vector<uint64>();
+	positions.reserve(data.size());
 	for (int i = 0, l = data.size(); i != l; ++i) {
 		const auto &message = data[i];
 		if (message.type() == mtpc_message) {
@@ -1722,11 +1733,12 @@ void Session::processMessages(
 			}
 		}
 		const auto id = IdFromMessage(message);
-		indices.emplace((uint64(uint32(id)) << 32) | uint64(i), i);
+		positions.push_back((uint64(uint32(id)) << 32) | uint64(i));
 	}
-	for (const auto [position, index] : indices) {
+	ranges::sort(positions);
+	for (const auto position : positions) {
 		addNewMessage(
-			data[index],
+			data[int(position & 0xFFFFFFFFULL)],
 			MTPDmessage_ClientFlags(),
 			type);
 	}
@@ -2443,7 +2455,9 @@ void Session::documentConvert(
 	}
 	documentApplyFields(original, data);
 	if (idChanged) {
-		cache().moveIfEmpty(oldCacheKey, original->cacheKey());
+		cacheForTag(original->cacheTag()).moveIfEmpty(
+			oldCacheKey,
+			original->cacheKey());
 		if (savedGifs().indexOf(original) >= 0) {
 			Local::writeSavedGifs();
 		}
@@ -3170,15 +3184,18 @@ void Session::unregisterContactItem(
 }
 
 void Session::registerPlayingVideoFile(not_null<ViewElement*> view) {
-	if (++_playingVideoFiles[view] == 1) {
+	auto &file = _playingVideoFiles[view];
+	if (++file.count == 1) {
+		file.shown = crl::now();
 		registerHeavyViewPart(view);
+		checkPlayingVideoFilesLimit(view);
 	}
 }
 
 void Session::unregisterPlayingVideoFile(not_null<ViewElement*> view) {
 	const auto i = _playingVideoFiles.find(view);
 	if (i != _playingVideoFiles.end()) {
-		if (!--i->second) {
+		if (!--i->second.count) {
 			_playingVideoFiles.erase(i);
 			unregisterHeavyViewPart(view);
 		}
@@ -3187,8 +3204,40 @@ void Session::unregisterPlayingVideoFile(not_null<ViewElement*> view) {
 	}
 }
 
+void Session::markPlayingVideoFileShown(not_null<ViewElement*> view) {
+	const auto i = _playingVideoFiles.find(view);
+	if (i != _playingVideoFiles.end()) {
+		i->second.shown = crl::now();
+	}
+}
+
+void Session::checkPlayingVideoFilesLimit(not_null<ViewElement*> added) {
+	// Stop the players that were not painted for a while, starting from
+	// the least recently shown one, to keep the count of decoders small.
+	while (_playingVideoFiles.size() > kMaxPlayingVideoFiles) {
+		const auto hidden = crl::now() - kPlayingVideoFileHiddenTimeout;
+		auto oldest = (ViewElement*)nullptr;
+		auto oldestShown = hidden;
+		for (const auto &[view, file] : _playingVideoFiles) {
+			if (view != added && file.shown < oldestShown) {
+				oldest = view;
+				oldestShown = file.shown;
+			}
+		}
+		const auto media = oldest ? oldest->media() : nullptr;
+		if (!media) {
+			return;
+		}
+		const auto count = _playingVideoFiles.size();
+		media->stopAnimation();
+		if (_playingVideoFiles.size() == count) {
+			return;
+		}
+	}
+}
+
 void Session::stopPlayingVideoFiles() {
-	for (const auto &[view, count] : base::take(_playingVideoFiles)) {
+	for (const auto &[view, file] : base::take(_playingVideoFiles)) {
 		if (const auto media = view->media()) {
 			media->stopAnimation();
 		}
@@ -3197,10 +3246,12 @@ void Session::stopPlayingVideoFiles() {
 
 void Session::checkPlayingVideoFiles() {
 	const auto old = base::take(_playingVideoFiles);
-	for (const auto &[view, count] : old) {
+	for (const auto &[view, file] : old) {
 		if (const auto media = view->media()) {
 			if (const auto left = media->checkAnimationCount()) {
-				_playingVideoFiles.emplace(view, left);
+				_playingVideoFiles.emplace(
+					view,
+					PlayingVideoFile{ left, file.shown });
 				registerHeavyViewPart(view);
 				continue;
 			}
@@ -3325,6 +3376,56 @@ void Session::unregisterItemView(not_null<ViewElement*> view) {
 	}
 }
 
+QString Session::internedName(const QString &name) {
+	if (name.isEmpty()) {
+		return name;
+	}
+	const auto i = _internedNames.constFind(name);
+	if (i != _internedNames.cend()) {
+		return *i;
+	}
+	if (_internedNames.size() >= _internedNamesCleanupSize) {
+		// A detached string is not used by any message anymore.
+		for (auto j = _internedNames.begin(); j != _internedNames.end();) {
+			if (j->isDetached()) {
+				j = _internedNames.erase(j);
+			} else {
+				++j;
+			}
+		}
+		_internedNamesCleanupSize = std::max(
+			int(_internedNames.size()) * 2,
+			kInternedNamesCleanupSize);
+	}
+	_internedNames.insert(name);
+	return name;
+}
+
+std::shared_ptr<HiddenSenderInfo> Session::hiddenSenderInfo(
+		const QString &name) {
+	const auto i = _hiddenSenderInfos.find(name);
+	if (i != end(_hiddenSenderInfos)) {
+		if (auto result = i->second.lock()) {
+			return result;
+		}
+	}
+	if (_hiddenSenderInfos.size() >= _hiddenSenderInfosCleanupSize) {
+		for (auto j = begin(_hiddenSenderInfos); j != end(_hiddenSenderInfos);) {
+			if (j->second.expired()) {
+				j = _hiddenSenderInfos.erase(j);
+			} else {
+				++j;
+			}
+		}
+		_hiddenSenderInfosCleanupSize = std::max(
+			int(_hiddenSenderInfos.size()) * 2,
+			kHiddenSenderInfosCleanupSize);
+	}
+	auto result = std::make_shared<HiddenSenderInfo>(name);
+	_hiddenSenderInfos[name] = result;
+	return result;
+}
+
 not_null<Folder*> Session::folder(FolderId id) {
 	if (const auto result = folderLoaded(id)) {
 		return result;
@@ -3431,6 +3532,36 @@ auto Session::refreshChatListEntry(
 	return result;
 }
 
+void Session::adjustChatListEntries(
+		const base::flat_set<Dialogs::Key> &keys) {
+	auto folders = base::flat_map<Data::Folder*, std::vector<Dialogs::Key>>();
+	auto filters = base::flat_map<FilterId, std::vector<Dialogs::Key>>();
+	for (const auto key : keys) {
+		const auto entry = key.entry();
+		if (!entry->inChatList()) {
+			continue;
+		}
+		folders[entry->folder()].push_back(key);
+		for (const auto &filter : _chatsFilters->list()) {
+			if (entry->inChatList(filter.id())) {
+				filters[filter.id()].push_back(key);
+			}
+		}
+	}
+	for (const auto &[folder, list] : folders) {
+		chatsList(folder)->indexed()->adjustByDate(list);
+	}
+	for (const auto &[id, list] : filters) {
+		chatsFilters().chatsList(id)->indexed()->adjustByDate(list);
+	}
+	for (const auto &[folder, list] : folders) {
+		chatsListChanged(folder);
+	}
+	if (!filters.empty() && !folders.contains(nullptr)) {
+		chatsListChanged(nullptr);
+	}
+}
+
 void Session::removeChatListEntry(Dialogs::Key key) {
 	using namespace Dialogs;
 
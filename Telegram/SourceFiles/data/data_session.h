@@ -23,6 +23,7 @@ class Image;
 class HistoryItem;
 class HistoryMessage;
 class HistoryService;
+struct HiddenSenderInfo;
 struct WebPageCollage;
 enum class WebPageType;
 enum class NewMessageType;
@@ -129,6 +130,7 @@ public:
 
 	[[nodiscard]] Storage::Cache::Database &cache();
 	[[nodiscard]] Storage::Cache::Database &cacheBigFile();
+	[[nodiscard]] Storage::Cache::Database &cacheForTag(uint8 tag);
 
 	[[nodiscard]] not_null<PeerData*> peer(PeerId id);
 	[[nodiscard]] not_null<PeerData*> peer(UserId id) = delete;
@@ -601,6 +603,7 @@ public:
 
 	void registerPlayingVideoFile(not_null<ViewElement*> view);
 	void unregisterPlayingVideoFile(not_null<ViewElement*> view);
+	void markPlayingVideoFileShown(not_null<ViewElement*> view);
 	void checkPlayingVideoFiles();
 	void stopPlayingVideoFiles();
 
@@ -617,6 +620,11 @@ public:
 	void registerItemView(not_null<ViewElement*> view);
 	void unregisterItemView(not_null<ViewElement*> view);
 
+	// Names repeated in many messages share a single copy.
+	[[nodiscard]] QString internedName(const QString &name);
+	[[nodiscard]] std::shared_ptr<HiddenSenderInfo> hiddenSenderInfo(
+		const QString &name);
+
 	[[nodiscard]] not_null<Folder*> folder(FolderId id);
 	[[nodiscard]] Folder *folderLoaded(FolderId id) const;
 	not_null<Folder*> processFolder(const MTPFolder &data);
@@ -641,6 +649,10 @@ public:
 		FilterId filterIdForResult);
 	void removeChatListEntry(Dialogs::Key key);
 
+	// Moves these entries in all the lists containing them, when their
+	// positions were not adjusted each time their sort keys changed.
+	void adjustChatListEntries(const base::flat_set<Dialogs::Key> &keys);
+
 	struct DialogsRowReplacement {
 		not_null<Dialogs::Row*> old;
 		Dialogs::Row *now = nullptr;
@@ -826,6 +838,7 @@ private:
 	void setWallpapers(const QVector<MTPWallPaper> &data, int32 hash);
 
 	void checkPollsClosings();
+	void checkPlayingVideoFilesLimit(not_null<ViewElement*> added);
 
 	not_null<Main::Session*> _session;
 
@@ -942,7 +955,13 @@ private:
 	std::unordered_map<
 		UserId,
 		base::flat_set<not_null<ViewElement*>>> _contactViews;
-	base::flat_map<not_null<ViewElement*>, int> _playingVideoFiles;
+	struct PlayingVideoFile {
+		int count = 0;
+		crl::time shown = 0;
+	};
+	base::flat_map<
+		not_null<ViewElement*>,
+		PlayingVideoFile> _playingVideoFiles;
 
 	base::flat_set<not_null<WebPageData*>> _webpagesUpdated;
 	base::flat_set<not_null<GameData*>> _gamesUpdated;
@@ -960,6 +979,13 @@ private:
 
 	base::flat_set<not_null<ViewElement*>> _heavyViewParts;
 
+	QSet<QString> _internedNames;
+	int _internedNamesCleanupSize = 0;
+	base::flat_map<
+		QString,
+		std::weak_ptr<HiddenSenderInfo>> _hiddenSenderInfos;
+	int _hiddenSenderInfosCleanupSize = 0;
+
 	PeerData *_topPromoted = nullptr;
 
 	NotifySettings _defaultUserNotifySettings;
@@ -55,6 +55,10 @@ Storage::Cache::Key DocumentCacheKey(int32 dcId, uint64 id) {
 	};
 }
 
+bool IsBigFileCacheTag(uint8 tag) {
+	return (tag == kVideoMessageCacheTag) || (tag == kAnimationCacheTag);
+}
+
 Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id) {
 	const auto part = (uint64(dcId) & Data::kDocumentThumbCacheMask);
 	return Storage::Cache::Key{
@@ -54,6 +54,11 @@ constexpr auto kVoiceMessageCacheTag = uint8(0x03);
 constexpr auto kVideoMessageCacheTag = uint8(0x04);
 constexpr auto kAnimationCacheTag = uint8(0x05);
 
+// Whole round videos and animations are heavy, they are kept in the
+// big file cache together with streamed slices, so that they don't
+// push small images and stickers out of the main cache budget.
+[[nodiscard]] bool IsBigFileCacheTag(uint8 tag);
+
 struct FileOrigin;
 
 class ReplyPreview {
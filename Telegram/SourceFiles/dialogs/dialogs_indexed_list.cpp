@@ -61,6 +61,30 @@ void IndexedList::adjustByDate(const RowsByLetter &links) {
 	}
 }
 
+void IndexedList::adjustByDate(const std::vector<Key> &keys) {
+	auto main = std::vector<not_null<Row*>>();
+	auto letters = base::flat_map<QChar, std::vector<not_null<Row*>>>();
+	main.reserve(keys.size());
+	for (const auto key : keys) {
+		if (const auto row = _list.getRow(key)) {
+			main.push_back(row);
+		}
+		for (const auto ch : key.entry()->chatListFirstLetters()) {
+			if (auto it = _index.find(ch); it != _index.cend()) {
+				if (const auto row = it->second.getRow(key)) {
+					letters[ch].push_back(row);
+				}
+			}
+		}
+	}
+	if (!main.empty()) {
+		_list.adjustByDate(main);
+	}
+	for (const auto &[ch, rows] : letters) {
+		_index.find(ch)->second.adjustByDate(rows);
+	}
+}
+
 void IndexedList::moveToTop(Key key) {
 	if (_list.moveToTop(key)) {
 		for (const auto ch : key.entry()->chatListFirstLetters()) {
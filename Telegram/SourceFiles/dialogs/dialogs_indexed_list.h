@@ -21,6 +21,7 @@ public:
 	RowsByLetter addToEnd(Key key);
 	Row *addByName(Key key);
 	void adjustByDate(const RowsByLetter &links);
+	void adjustByDate(const std::vector<Key> &keys);
 	void moveToTop(Key key);
 
 	// row must belong to this indexed list all().
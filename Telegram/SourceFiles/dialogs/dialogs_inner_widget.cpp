@@ -1438,6 +1438,31 @@ void InnerWidget::dialogRowReplaced(
 }
 
 void InnerWidget::refreshDialog(Key key) {
+	refreshDialog(key, std::nullopt);
+}
+
+void InnerWidget::refreshDialogs(const base::flat_set<Key> &keys) {
+	// Rows are moved in all the lists at once, so remember where they
+	// were before to keep the scroll position in onDialogMoved().
+	auto positions = base::flat_map<Key, int>();
+	for (const auto key : keys) {
+		if (key.entry()->inChatList(_filterId)) {
+			positions.emplace(key, key.entry()->posInChatList(_filterId));
+		}
+	}
+	session().data().adjustChatListEntries(keys);
+	for (const auto key : keys) {
+		const auto i = positions.find(key);
+		const auto positionBefore = (i != end(positions))
+			? std::make_optional(i->second)
+			: std::nullopt;
+		refreshDialog(key, positionBefore);
+	}
+}
+
+void InnerWidget::refreshDialog(
+		Key key,
+		std::optional<int> positionBefore) {
 	if (const auto history = key.history()) {
 		if (history->peer->loadedStatus
 			!= PeerData::LoadedStatus::FullLoaded) {
@@ -1451,8 +1476,11 @@ void InnerWidget::refreshDialog(Key key) {
 	const auto result = session().data().refreshChatListEntry(
 		key,
 		_filterId);
+	const auto movedFrom = (positionBefore && result.moved.to >= 0)
+		? *positionBefore
+		: result.moved.from;
 	const auto rowHeight = st::dialogsRowHeight;
-	const auto from = dialogsOffset() + result.moved.from * rowHeight;
+	const auto from = dialogsOffset() + movedFrom * rowHeight;
 	const auto to = dialogsOffset() + result.moved.to * rowHeight;
 	if (!_dragging
 		&& (from != to)
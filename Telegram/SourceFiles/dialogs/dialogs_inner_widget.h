@@ -89,6 +89,7 @@ public:
 	void selectSkipPage(int32 pixels, int32 direction);
 
 	void refreshDialog(Key key);
+	void refreshDialogs(const base::flat_set<Key> &keys);
 	void removeDialog(Key key);
 	void repaintDialogRow(FilterId filterId, not_null<Row*> row);
 	void repaintDialogRow(RowDescriptor row);
@@ -181,6 +182,7 @@ private:
 	Main::Session &session() const;
 
 	void dialogRowReplaced(Row *oldRow, Row *newRow);
+	void refreshDialog(Key key, std::optional<int> positionBefore);
 
 	void editOpenedFilter();
 	void repaintCollapsedFolderRow(not_null<Data::Folder*> folder);
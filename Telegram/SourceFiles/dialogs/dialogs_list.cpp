@@ -13,6 +13,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 
 namespace Dialogs {
+namespace {
+
+constexpr auto kAdjustByDateRowsMax = 16;
+
+} // namespace
 
 List::List(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -105,6 +110,55 @@ void List::adjustByDate(not_null<Row*> row) {
 	}
 }
 
+void List::adjustByDate(const std::vector<not_null<Row*>> &rows) {
+	Expects(_sortMode == SortMode::Date);
+
+	if (rows.size() == 1) {
+		adjustByDate(rows.front());
+		return;
+	} else if (rows.size() > kAdjustByDateRowsMax) {
+		sortByDate();
+		return;
+	}
+
+	// Other rows may be misplaced as well, so a row can't be moved by
+	// comparing it with its neighbours. Take all of them out, the rest
+	// of the list stays sorted, and insert them back one by one.
+	const auto misplaced = base::flat_set<not_null<Row*>>(
+		rows.begin(),
+		rows.end());
+	const auto isMisplaced = [&](not_null<Row*> row) {
+		return misplaced.contains(row);
+	};
+	_rows.erase(
+		std::remove_if(_rows.begin(), _rows.end(), isMisplaced),
+		_rows.end());
+	for (const auto row : misplaced) {
+		const auto key = row->sortKey(_filterId);
+		const auto before = std::find_if(_rows.begin(), _rows.end(), [&](
+				not_null<Row*> other) {
+			return (other->sortKey(_filterId) <= key);
+		});
+		_rows.insert(before, row);
+	}
+	for (auto i = 0, count = int(_rows.size()); i != count; ++i) {
+		_rows[i]->_pos = i;
+	}
+}
+
+void List::sortByDate() {
+	Expects(_sortMode == SortMode::Date);
+
+	std::stable_sort(_rows.begin(), _rows.end(), [&](
+			not_null<Row*> a,
+			not_null<Row*> b) {
+		return (a->sortKey(_filterId) > b->sortKey(_filterId));
+	});
+	for (auto i = 0, count = int(_rows.size()); i != count; ++i) {
+		_rows[i]->_pos = i;
+	}
+}
+
 bool List::moveToTop(Key key) {
 	const auto i = _rowByKey.find(key);
 	if (i == _rowByKey.cend()) {
@@ -49,6 +49,8 @@ public:
 	not_null<Row*> addByName(Key key);
 	bool moveToTop(Key key);
 	void adjustByDate(not_null<Row*> row);
+	void adjustByDate(const std::vector<not_null<Row*>> &rows);
+	void sortByDate();
 	bool del(Key key, Row *replacedBy = nullptr);
 
 	using const_iterator = std::vector<not_null<Row*>>::const_iterator;
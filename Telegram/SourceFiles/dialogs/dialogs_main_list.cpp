@@ -192,6 +192,15 @@ rpl::producer<UnreadState> MainList::unreadStateChanges() const {
 	return _unreadStateChanges.events();
 }
 
+void MainList::finishUnreadStateChangesBatch() {
+	Expects(_unreadStateBatchLevel > 0);
+
+	if (!--_unreadStateBatchLevel && _unreadStateBatchChanged) {
+		_unreadStateBatchChanged = false;
+		_unreadStateChanges.fire_copy(_unreadStateBatchWas);
+	}
+}
+
 not_null<IndexedList*> MainList::indexed() {
 	return &_all;
 }
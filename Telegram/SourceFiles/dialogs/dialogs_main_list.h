@@ -36,6 +36,15 @@ public:
 	[[nodiscard]] UnreadState unreadState() const;
 	[[nodiscard]] rpl::producer<UnreadState> unreadStateChanges() const;
 
+	// Bulk changes fire a single unreadStateChanges() event at the end.
+	[[nodiscard]] auto unreadStateChangesBatch() {
+		if (!_unreadStateBatchLevel++) {
+			_unreadStateBatchWas = unreadState();
+			_unreadStateBatchChanged = false;
+		}
+		return gsl::finally([=] { finishUnreadStateChangesBatch(); });
+	}
+
 	[[nodiscard]] not_null<IndexedList*> indexed();
 	[[nodiscard]] not_null<const IndexedList*> indexed() const;
 	[[nodiscard]] not_null<PinnedList*> pinned();
@@ -48,7 +57,13 @@ private:
 	void finalizeCloudUnread();
 	void recomputeFullListSize();
 
+	void finishUnreadStateChangesBatch();
+
 	auto unreadStateChangeNotifier(bool notify) {
+		if (notify && _unreadStateBatchLevel > 0) {
+			_unreadStateBatchChanged = true;
+			notify = false;
+		}
 		const auto wasState = notify ? unreadState() : UnreadState();
 		return gsl::finally([=] {
 			if (notify) {
@@ -63,6 +78,9 @@ private:
 	UnreadState _unreadState;
 	UnreadState _cloudUnreadState;
 	rpl::event_stream<UnreadState> _unreadStateChanges;
+	UnreadState _unreadStateBatchWas;
+	int _unreadStateBatchLevel = 0;
+	bool _unreadStateBatchChanged = false;
 	rpl::variable<int> _fullListSize = 0;
 	int _cloudListSize = 0;
 
@@ -539,6 +539,10 @@ void Widget::refreshDialog(Key key) {
 	}
 }
 
+void Widget::refreshDialogs(const base::flat_set<Key> &keys) {
+	_inner->refreshDialogs(keys);
+}
+
 void Widget::repaintDialogRow(
 		FilterId filterId,
 		not_null<Row*> row) {
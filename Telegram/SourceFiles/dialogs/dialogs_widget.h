@@ -61,6 +61,7 @@ public:
 	void setInnerFocus();
 
 	void refreshDialog(Key key);
+	void refreshDialogs(const base::flat_set<Key> &keys);
 	void removeDialog(Key key);
 	void repaintDialogRow(FilterId filterId, not_null<Row*> row);
 	void repaintDialogRow(RowDescriptor row);
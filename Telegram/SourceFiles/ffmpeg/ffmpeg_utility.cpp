@@ -12,6 +12,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QImage>
 
+#include <mutex>
+#include <atomic>
+#include <thread>
+
 #ifdef LIB_FFMPEG_USE_QT_PRIVATE_API
 #include <private/qdrawhelper_p.h>
 #endif // LIB_FFMPEG_USE_QT_PRIVATE_API
@@ -30,10 +34,116 @@ constexpr auto kMaxScaleByAspectRatio = 16;
 constexpr auto kAvioBlockSize = 4096;
 constexpr auto kTimeUnknown = std::numeric_limits<crl::time>::min();
 constexpr auto kDurationMax = crl::time(std::numeric_limits<int>::max());
+constexpr auto kFrameBuffersPoolLimit = 16 * 1024 * 1024;
+constexpr auto kSingleThreadDecodeMaxPixels = 640 * 480;
+constexpr auto kPixelsPerDecoderThread = 1280 * 720 / 2;
+constexpr auto kMaxDecoderThreadsPerCodec = 8;
+
+// Extra decoder threads (above the calling thread) over all codecs.
+std::atomic<int> DecoderThreadsUsed = 0;
+
+struct FrameBuffer {
+	explicit FrameBuffer(int size) : data(new uchar[size]), size(size) {
+	}
+
+	std::unique_ptr<uchar[]> data;
+	int size = 0;
+};
+
+// Frame storages released by finished or destroyed video tracks are
+// kept here, so that the next track of the same size (round videos,
+// autoplaying GIFs while scrolling) doesn't allocate them again.
+struct FrameBuffersPool {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<FrameBuffer>> list;
+	int total = 0;
+};
+
+[[nodiscard]] FrameBuffersPool &FrameBuffers() {
+	// Never destroyed, images may outlive static objects.
+	static const auto result = new FrameBuffersPool();
+	return *result;
+}
+
+[[nodiscard]] std::unique_ptr<FrameBuffer> TakeFrameBuffer(int size) {
+	auto &pool = FrameBuffers();
+	auto lock = std::unique_lock<std::mutex>(pool.mutex);
+	const auto i = std::find_if(
+		begin(pool.list),
+		end(pool.list),
+		[&](const auto &buffer) { return (buffer->size == size); });
+	if (i != end(pool.list)) {
+		auto result = std::move(*i);
+		pool.list.erase(i);
+		pool.total -= size;
+		return result;
+	}
+	lock.unlock();
+	return std::make_unique<FrameBuffer>(size);
+}
 
 void AlignedImageBufferCleanupHandler(void* data) {
-	const auto buffer = static_cast<uchar*>(data);
-	delete[] buffer;
+	auto buffer = std::unique_ptr<FrameBuffer>(
+		static_cast<FrameBuffer*>(data));
+	if (buffer->size > kFrameBuffersPoolLimit) {
+		return;
+	}
+	auto &pool = FrameBuffers();
+	auto removed = std::vector<std::unique_ptr<FrameBuffer>>();
+	auto lock = std::unique_lock<std::mutex>(pool.mutex);
+	pool.total += buffer->size;
+	pool.list.push_back(std::move(buffer));
+
+	// Drop the least recently released buffers outside of the lock.
+	auto from = begin(pool.list);
+	while (pool.total > kFrameBuffersPoolLimit) {
+		pool.total -= (*from)->size;
+		removed.push_back(std::move(*from++));
+	}
+	pool.list.erase(begin(pool.list), from);
+	lock.unlock();
+}
+
+[[nodiscard]] int DecoderThreadsLimit() {
+	static const auto result = std::max(
+		int(std::thread::hardware_concurrency()),
+		2);
+	return result;
+}
+
+// Small videos, like GIFs and round videos, which may be many at once,
+// are decoded on the caller thread. Large ones get a thread per
+// kPixelsPerDecoderThread, while the global budget allows it.
+[[nodiscard]] int AcquireDecoderThreads(
+		not_null<const AVCodecParameters*> parameters) {
+	if (parameters->codec_type != AVMEDIA_TYPE_VIDEO) {
+		return 1;
+	}
+	const auto pixels = int64(parameters->width) * parameters->height;
+	if (pixels <= kSingleThreadDecodeMaxPixels) {
+		return 1;
+	}
+	const auto byPixels = std::min(
+		pixels / kPixelsPerDecoderThread,
+		int64(kMaxDecoderThreadsPerCodec));
+	const auto wanted = std::min(int(byPixels), DecoderThreadsLimit()) - 1;
+	auto used = DecoderThreadsUsed.load();
+	while (true) {
+		const auto extra = std::min(wanted, DecoderThreadsLimit() - used);
+		if (extra <= 0) {
+			return 1;
+		} else if (DecoderThreadsUsed.compare_exchange_weak(
+				used,
+				used + extra)) {
+			return 1 + extra;
+		}
+	}
+}
+
+void ReleaseDecoderThreads(int count) {
+	if (count > 1) {
+		DecoderThreadsUsed -= (count - 1);
+	}
 }
 
 [[nodiscard]] bool IsValidAspectRatio(AVRational aspect) {
@@ -177,19 +287,31 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 	av_codec_set_pkt_timebase(context, stream->time_base);
 	av_opt_set_int(context, "refcounted_frames", 1, 0);
 
+	const auto threads = AcquireDecoderThreads(stream->codecpar);
+	context->thread_count = threads;
+	context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	const auto codec = avcodec_find_decoder(context->codec_id);
 	if (!codec) {
+		ReleaseDecoderThreads(threads);
+		context->thread_count = 1;
 		LogError(qstr("avcodec_find_decoder"), context->codec_id);
 		return {};
 	} else if ((error = avcodec_open2(context, codec, nullptr))) {
+		ReleaseDecoderThreads(threads);
+		context->thread_count = 1;
 		LogError(qstr("avcodec_open2"), error);
 		return {};
 	}
+
+	// The codec may use less threads than requested.
+	ReleaseDecoderThreads(threads - context->thread_count + 1);
 	return result;
 }
 
 void CodecDeleter::operator()(AVCodecContext *value) {
 	if (value) {
+		ReleaseDecoderThreads(value->thread_count);
 		avcodec_free_context(&value);
 	}
 }
@@ -376,8 +498,9 @@ QImage CreateFrameStorage(QSize size) {
 		? (widthAlign - (width % widthAlign))
 		: 0);
 	const auto perLine = neededWidth * kPixelBytesSize;
-	const auto buffer = new uchar[perLine * height + kAlignImageBy];
-	const auto cleanupData = static_cast<void *>(buffer);
+	auto frameBuffer = TakeFrameBuffer(perLine * height + kAlignImageBy);
+	const auto buffer = frameBuffer->data.get();
+	const auto cleanupData = static_cast<void *>(frameBuffer.release());
 	const auto address = reinterpret_cast<uintptr_t>(buffer);
 	const auto alignedBuffer = buffer + ((address % kAlignImageBy)
 		? (kAlignImageBy - (address % kAlignImageBy))
@@ -61,6 +61,10 @@ constexpr auto kStatusShowClientsideChooseContact = 6000;
 constexpr auto kStatusShowClientsidePlayGame = 10000;
 constexpr auto kSetMyActionForMs = 10000;
 constexpr auto kNewBlockEachMessage = 50;
+constexpr auto kResizeAroundScrollTopBlocks = 2;
+constexpr auto kResizeLazyBlocksPerStep = 4;
+constexpr auto kUnloadBlocksMinCount = 2;
+constexpr auto kRestoreUnloadedPerStep = 50;
 constexpr auto kSkipCloudDraftsFor = TimeId(3);
 
 } // namespace
@@ -128,6 +132,10 @@ bool History::hasPendingResizedItems() const {
 	return _flags & Flag::f_has_pending_resized_items;
 }
 
+bool History::hasLazyResizedBlocks() const {
+	return _flags & Flag::f_has_lazy_resized_blocks;
+}
+
 void History::setHasPendingResizedItems() {
 	_flags |= Flag::f_has_pending_resized_items;
 }
@@ -2914,18 +2922,80 @@ HistoryItem *History::lastSentMessage() const {
 }
 
 void History::resizeToWidth(int newWidth) {
-	const auto resizeAllItems = (_width != newWidth);
+	const auto widthChanged = (_width != newWidth);
+	const auto hadPendingItems = hasPendingResizedItems();
 
-	if (!resizeAllItems && !hasPendingResizedItems()) {
+	if (!widthChanged && !hadPendingItems && !hasLazyResizedBlocks()) {
 		return;
 	}
-	_flags &= ~(Flag::f_has_pending_resized_items);
+	_flags &= ~(Flag::f_has_pending_resized_items
+		| Flag::f_has_lazy_resized_blocks);
 
 	_width = newWidth;
-	int y = 0;
+	if (blocks.empty()) {
+		_height = 0;
+		return;
+	}
+
+	// Blocks around the scroll top item (or the bottom, if we're there)
+	// are laid out right away, a few blocks more are laid out in the order
+	// of their distance from it, and the rest keep their old heights
+	// until the next call, see HistoryWidget::_lazyResizeTimer.
+	const auto count = int(blocks.size());
+	const auto anchor = scrollTopItem
+		? scrollTopItem->block()->indexInHistory()
+		: (count - 1);
+	if (widthChanged
+		|| _lazyResize.anchor != anchor
+		|| _lazyResize.count != count) {
+		_lazyResize = { anchor, count, 1 };
+	}
+	const auto from = std::max(anchor - kResizeAroundScrollTopBlocks, 0);
+	const auto till = std::min(
+		anchor + kResizeAroundScrollTopBlocks + 1,
+		count);
+	auto lazyLeft = kResizeLazyBlocksPerStep;
+	const auto resizeLazy = [&](int index) {
+		if (index < 0 || index >= count) {
+			return;
+		}
+		const auto &block = blocks[index];
+		if (block->resizedWidth() != newWidth) {
+			block->resizeGetHeight(newWidth, true);
+			--lazyLeft;
+		}
+	};
+	for (auto i = from; i != till; ++i) {
+		if (blocks[i]->resizedWidth() != newWidth) {
+			blocks[i]->resizeGetHeight(newWidth, true);
+		}
+	}
+	auto &distance = _lazyResize.distance;
+	for (; lazyLeft > 0; ++distance) {
+		const auto above = from - distance;
+		const auto below = till - 1 + distance;
+		if (above < 0 && below >= count) {
+			break;
+		}
+		resizeLazy(below);
+		resizeLazy(above);
+	}
+
+	auto y = 0;
 	for (const auto &block : blocks) {
 		block->setY(y);
-		y += block->resizeGetHeight(newWidth, resizeAllItems);
+		y += hadPendingItems
+			? block->resizeGetHeight(newWidth, false)
+			: block->height();
+		if (block->resizedWidth() != newWidth) {
+			_flags |= Flag::f_has_lazy_resized_blocks;
+		}
+	}
+	if (hasLazyResizedBlocks()
+		&& (from - distance < 0)
+		&& (till - 1 + distance >= count)) {
+		// Some blocks were skipped by the cursor, start over next time.
+		distance = 1;
 	}
 	_height = y;
 }
@@ -2933,6 +3003,9 @@ void History::resizeToWidth(int newWidth) {
 void History::forceFullResize() {
 	_width = 0;
 	_flags |= Flag::f_has_pending_resized_items;
+	for (const auto &block : blocks) {
+		block->invalidateResizedWidth();
+	}
 }
 
 ChannelId History::channelId() const {
@@ -3200,6 +3273,7 @@ void History::clear(ClearType type) {
 
 	forgetScrollState();
 	blocks.clear();
+	_unloadedAbove.clear();
 	owner().notifyHistoryUnloaded(this);
 	lastKeyboardInited = false;
 	if (type == ClearType::Unload) {
@@ -3278,6 +3352,93 @@ void History::clearUpTill(MsgId availableMinId) {
 	requestChatListMessage();
 }
 
+bool History::unloadBlocksAbove(int top) {
+	if (isBuildingFrontBlock()) {
+		return false;
+	}
+	auto from = 0;
+	const auto countRange = [&] {
+		const auto count = int(blocks.size());
+		from = 0;
+		while (from + 1 < count
+			&& blocks[from]->y() + blocks[from]->height() <= top) {
+			++from;
+		}
+		return (from >= kUnloadBlocksMinCount);
+	};
+	if (!countRange()) {
+		return false;
+	}
+	const auto unloaded = [&](Element *view) {
+		return view && (view->block()->indexInHistory() < from);
+	};
+	if (_joinedMessage && unloaded(_joinedMessage->mainView())) {
+		// Destroying it may remove its block, so count the range again.
+		removeJoinedMessage();
+		if (!countRange()) {
+			return false;
+		}
+	}
+	if (unloaded(_unreadBarView)) {
+		_unreadBarView = nullptr;
+	}
+	if (unloaded(_firstUnreadView)) {
+		_firstUnreadView = nullptr;
+	}
+	if (unloaded(scrollTopItem)) {
+		forgetScrollState();
+	}
+
+	if (_unloadedAbove.empty()) {
+		_unloadedAboveAtTop = _loadedAtTop;
+	}
+	for (auto i = 0; i != from; ++i) {
+		for (const auto &view : blocks[i]->messages) {
+			_unloadedAbove.push_back(view->data()->id);
+		}
+	}
+	blocks.erase(begin(blocks), begin(blocks) + from);
+	for (auto i = 0, l = int(blocks.size()); i != l; ++i) {
+		blocks[i]->setIndexInHistory(i);
+	}
+	blocks.front()->messages.front()->previousInBlocksChanged();
+	_loadedAtTop = false;
+	setHasPendingResizedItems();
+	return true;
+}
+
+bool History::restoreUnloadedAbove() {
+	if (_unloadedAbove.empty() || isBuildingFrontBlock()) {
+		return false;
+	}
+	const auto count = std::min(
+		int(_unloadedAbove.size()),
+		kRestoreUnloadedPerStep);
+	const auto from = end(_unloadedAbove) - count;
+	auto items = std::vector<not_null<HistoryItem*>>();
+	items.reserve(count);
+	for (auto i = from; i != end(_unloadedAbove); ++i) {
+		// Deleted items are gone and some could be shown again already.
+		const auto item = owner().message(channelId(), *i);
+		if (item && item->history() == this && !item->mainView()) {
+			items.push_back(item);
+		}
+	}
+	_unloadedAbove.erase(from, end(_unloadedAbove));
+
+	if (!items.empty()) {
+		startBuildingFrontBlock(items.size());
+		for (const auto item : items) {
+			addItemToBlock(item);
+		}
+		finishBuildingFrontBlock();
+	}
+	if (_unloadedAbove.empty()) {
+		_loadedAtTop = _unloadedAboveAtTop;
+	}
+	return true;
+}
+
 void History::applyGroupAdminChanges(const base::flat_set<UserId> &changes) {
 	for (const auto &block : blocks) {
 		for (const auto &message : block->messages) {
@@ -3319,14 +3480,27 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 
 int HistoryBlock::resizeGetHeight(int newWidth, bool resizeAllItems) {
 	auto y = 0;
+
+	// Items keep their width after an invalidation, so only a full
+	// resize can mark such block as laid out again.
+	auto allResized = resizeAllItems || !_layoutInvalidated;
 	for (const auto &message : messages) {
 		message->setY(y);
 		if (resizeAllItems || message->pendingResize()) {
 			y += message->resizeGetHeight(newWidth);
 		} else {
 			y += message->height();
+			if (message->width() != newWidth) {
+				allResized = false;
+			}
 		}
 	}
+
+	// A block with items of different widths is stale for any width.
+	_resizedWidth = allResized ? newWidth : 0;
+	if (resizeAllItems) {
+		_layoutInvalidated = false;
+	}
 	_height = y;
 	return _height;
 }
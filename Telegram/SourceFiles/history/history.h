@@ -89,6 +89,15 @@ public:
 	void clear(ClearType type);
 	void clearUpTill(MsgId availableMinId);
 
+	// Destroys views of the blocks lying entirely above the top keeping
+	// the items, restoreUnloadedAbove() adds them back. The bottom is
+	// never unloaded, lastSentMessage() and new messages rely on it.
+	bool unloadBlocksAbove(int top);
+
+	// Adds back a front block from the items unloaded above, without
+	// requesting them from the server. Returns false if there are none.
+	bool restoreUnloadedAbove();
+
 	void applyGroupAdminChanges(const base::flat_set<UserId> &changes);
 
 	template <typename ...Args>
@@ -266,6 +275,9 @@ public:
 	bool hasPendingResizedItems() const;
 	void setHasPendingResizedItems();
 
+	// Some blocks still have heights computed for the previous width.
+	bool hasLazyResizedBlocks() const;
+
 	bool mySendActionUpdated(SendAction::Type type, bool doing);
 	bool paintSendAction(
 		Painter &p,
@@ -414,6 +426,7 @@ private:
 
 	enum class Flag {
 		f_has_pending_resized_items = (1 << 0),
+		f_has_lazy_resized_blocks = (1 << 1),
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) {
@@ -527,12 +540,24 @@ private:
 	bool _mute = false;
 	int _width = 0;
 	int _height = 0;
+
+	// Where the next lazy resize step continues from.
+	struct LazyResize {
+		int anchor = -1;
+		int count = 0;
+		int distance = 1;
+	};
+	LazyResize _lazyResize;
 	Element *_unreadBarView = nullptr;
 	Element *_firstUnreadView = nullptr;
 	HistoryService *_joinedMessage = nullptr;
 	bool _loadedAtTop = false;
 	bool _loadedAtBottom = true;
 
+	// Ids of the items unloaded by unloadBlocksAbove(), oldest first.
+	std::vector<MsgId> _unloadedAbove;
+	bool _unloadedAboveAtTop = false;
+
 	std::optional<Data::Folder*> _folder;
 
 	std::optional<MsgId> _inboxReadBefore;
@@ -606,6 +631,13 @@ public:
 	int height() const {
 		return _height;
 	}
+	int resizedWidth() const {
+		return _resizedWidth;
+	}
+	void invalidateResizedWidth() {
+		_resizedWidth = 0;
+		_layoutInvalidated = true;
+	}
 	not_null<History*> history() const {
 		return _history;
 	}
@@ -640,6 +672,8 @@ protected:
 
 	int _y = 0;
 	int _height = 0;
+	int _resizedWidth = 0;
 	int _indexInHistory = -1;
+	bool _layoutInvalidated = false;
 
 };
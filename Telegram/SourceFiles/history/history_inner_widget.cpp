@@ -31,6 +31,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/window_peer_menu.h"
 #include "window/window_controller.h"
 #include "window/notifications_manager.h"
+#include "window/themes/window_theme.h"
 #include "boxes/confirm_box.h"
 #include "boxes/report_box.h"
 #include "boxes/sticker_set_box.h"
@@ -67,6 +68,7 @@ namespace {
 
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kUnloadHeavyPartsPages = 1;
+constexpr auto kCachedElementsLimit = 64 * 1024 * 1024;
 
 // Helper binary search for an item in a list that is not completely
 // above the given top of the visible area or below the given bottom of the visible area
@@ -88,6 +90,10 @@ int BinarySearchBlocksOrItems(const T &list, int edge) {
 	return start;
 }
 
+[[nodiscard]] int64 ComputeUsage(const QImage &frame) {
+	return int64(frame.width()) * frame.height() * 4;
+}
+
 } // namespace
 
 // flick scroll taken from http://qt-project.org/doc/qt-4.8/demos-embedded-anomaly-src-flickcharm-cpp.html
@@ -144,7 +150,10 @@ HistoryInner::HistoryInner(
 , _history(history)
 , _migrated(history->migrateFrom())
 , _scrollDateCheck([this] { scrollDateCheck(); })
-, _scrollDateHideTimer([this] { scrollDateHideByTimer(); }) {
+, _scrollDateHideTimer([this] { scrollDateHideByTimer(); })
+, _cachedElementsUsage(kCachedElementsLimit, [=](const Element *view) {
+	forgetCachedElement(view);
+}) {
 	Instance = this;
 
 	_touchSelectTimer.setSingleShot(true);
@@ -166,6 +175,10 @@ HistoryInner::HistoryInner(
 	subscribe(_controller->widget()->dragFinished(), [this] {
 		mouseActionUpdate(QCursor::pos());
 	});
+	subscribe(Window::Theme::Background(), [=](
+			const Window::Theme::BackgroundUpdate &update) {
+		clearCachedElements();
+	});
 	session().data().itemRemoved(
 	) | rpl::start_with_next(
 		[this](auto item) { itemRemoved(item); },
@@ -240,6 +253,10 @@ void HistoryInner::repaintItem(const HistoryItem *item) {
 }
 
 void HistoryInner::repaintItem(const Element *view) {
+	if (!view) {
+		return;
+	}
+	forgetCachedElement(view);
 	if (_widget->skipItemRepaint()) {
 		return;
 	}
@@ -624,7 +641,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 					view,
 					selfromy - mtop,
 					seltoy - mtop);
-				view->draw(p, clip.translated(0, -y), selection, ms);
+				drawElement(p, view, clip.translated(0, -y), selection, ms);
 
 				if (item->hasViews()) {
 					App::main()->scheduleViewIncrement(item);
@@ -670,7 +687,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 						view,
 						selfromy - htop,
 						seltoy - htop);
-					view->draw(p, hclip.translated(0, -y), selection, ms);
+					drawElement(p, view, hclip.translated(0, -y), selection, ms);
 
 					const auto middle = y + h / 2;
 					const auto bottom = y + h;
@@ -1305,6 +1322,7 @@ void HistoryInner::itemRemoved(not_null<const HistoryItem*> item) {
 }
 
 void HistoryInner::viewRemoved(not_null<const Element*> view) {
+	forgetCachedElement(view);
 	if (_dragSelFrom == view) {
 		_dragSelFrom = nullptr;
 	}
@@ -1316,6 +1334,97 @@ void HistoryInner::viewRemoved(not_null<const Element*> view) {
 	}
 }
 
+bool HistoryInner::canCacheElement(not_null<const Element*> view) const {
+	// Media, inline keyboards, sending clocks, highlight and hover
+	// effects are animated, so such elements are painted every time.
+	// Replies show a lazily loaded original message with its thumbnail.
+	const auto item = view->data();
+	return !view->media()
+		&& !item->Has<HistoryMessageReply>()
+		&& !item->inlineReplyKeyboard()
+		&& !item->isSending()
+		&& !view->isUnderCursor()
+		&& (App::pressedItem() != view.get())
+		&& (App::hoveredLinkItem() != view.get())
+		&& (App::pressedLinkItem() != view.get())
+		&& !view->delegate()->elementHighlightTime(view);
+}
+
+void HistoryInner::drawElement(
+		Painter &p,
+		not_null<Element*> view,
+		QRect clip,
+		TextSelection selection,
+		crl::time ms) {
+	// Text is drawn to an opaque frame so that it keeps the subpixel
+	// antialiasing, that is possible only above a solid color background.
+	const auto fill = Window::Theme::Background()->colorForFill();
+	if (!fill || !canCacheElement(view)) {
+		forgetCachedElement(view);
+		view->draw(p, clip, selection, ms);
+		return;
+	}
+	const auto item = view->data();
+	const auto size = QSize(view->width(), view->height());
+	const auto unread = item->unread();
+	const auto views = item->viewsCount();
+	const auto bar = view->Get<HistoryView::UnreadBar>();
+	const auto unreadBar = bar ? bar->text : QString();
+	auto i = _cachedElements.find(view);
+	if (i != end(_cachedElements)
+		&& (i->second.selection != selection
+			|| i->second.frame.size() != size * cIntRetinaFactor()
+			|| i->second.unread != unread
+			|| i->second.views != views
+			|| i->second.unreadBar != unreadBar)) {
+		forgetCachedElement(view);
+		i = end(_cachedElements);
+	}
+	if (i == end(_cachedElements)) {
+		auto frame = QImage(
+			size * cIntRetinaFactor(),
+			QImage::Format_ARGB32_Premultiplied);
+		frame.setDevicePixelRatio(cRetinaFactor());
+		frame.fill(*fill);
+		{
+			Painter q(&frame);
+			view->draw(q, QRect(QPoint(), size), selection, ms);
+		}
+		_cachedElementsUsage.increment(ComputeUsage(frame));
+		i = _cachedElements.emplace(
+			view,
+			CachedElement{
+				std::move(frame),
+				selection,
+				unread,
+				views,
+				unreadBar }).first;
+	}
+	_cachedElementsUsage.up(view);
+	const auto part = clip.intersected(QRect(QPoint(), size));
+	if (!part.isEmpty()) {
+		p.drawImage(part, i->second.frame, QRect(
+			part.topLeft() * cIntRetinaFactor(),
+			part.size() * cIntRetinaFactor()));
+	}
+}
+
+void HistoryInner::forgetCachedElement(not_null<const Element*> view) {
+	const auto i = _cachedElements.find(view);
+	if (i != end(_cachedElements)) {
+		_cachedElementsUsage.decrement(ComputeUsage(i->second.frame));
+		_cachedElementsUsage.remove(view);
+		_cachedElements.erase(i);
+	}
+}
+
+void HistoryInner::clearCachedElements() {
+	_cachedElementsUsage.clear();
+	for (const auto &[view, cached] : base::take(_cachedElements)) {
+		_cachedElementsUsage.decrement(ComputeUsage(cached.frame));
+	}
+}
+
 void HistoryInner::refreshView(not_null<HistoryItem*> item) {
 	const auto dragSelFrom = (_dragSelFrom && _dragSelFrom->data() == item);
 	const auto dragSelTo = (_dragSelTo && _dragSelTo->data() == item);
@@ -2235,6 +2344,21 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	checkHistoryActivation();
 }
 
+bool HistoryInner::unloadBlocksAbove(int top) {
+	if (hasPendingResizedItems()) {
+		return false;
+	}
+
+	// The history is shown right below the migrated one, so its top
+	// blocks can be unloaded only if the migrated one is not shown.
+	if (const auto mtop = migratedTop(); mtop >= 0) {
+		return _migrated->unloadBlocksAbove(top - mtop);
+	} else if (const auto htop = historyTop(); htop >= 0) {
+		return _history->unloadBlocksAbove(top - htop);
+	}
+	return false;
+}
+
 bool HistoryInner::displayScrollDate() const {
 	return (_visibleAreaTop <= height() - 2 * (_visibleAreaBottom - _visibleAreaTop));
 }
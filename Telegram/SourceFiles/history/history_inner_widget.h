@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/tooltip.h"
 #include "ui/widgets/scroll_area.h"
 #include "history/view/history_view_top_bar_widget.h"
+#include "core/media_active_cache.h"
 
 namespace Data {
 struct Group;
@@ -97,6 +98,9 @@ public:
 	// updates history->scrollTopItem/scrollTopOffset
 	void visibleAreaUpdated(int top, int bottom);
 
+	// Unloads views of blocks lying above the top.
+	bool unloadBlocksAbove(int top);
+
 	int historyHeight() const;
 	int historyScrollTop() const;
 	int migratedTop() const;
@@ -241,6 +245,17 @@ private:
 	void viewRemoved(not_null<const Element*> view);
 	void refreshView(not_null<HistoryItem*> item);
 
+	// Static elements are drawn once to a frame and then just blitted.
+	void drawElement(
+		Painter &p,
+		not_null<Element*> view,
+		QRect clip,
+		TextSelection selection,
+		crl::time ms);
+	[[nodiscard]] bool canCacheElement(not_null<const Element*> view) const;
+	void forgetCachedElement(not_null<const Element*> view);
+	void clearCachedElements();
+
 	void touchResetSpeed();
 	void touchUpdateSpeed();
 	void touchDeaccelerate(int32 elapsed);
@@ -390,4 +405,17 @@ private:
 	int _scrollDateLastItemTop = 0;
 	ClickHandlerPtr _scrollDateLink;
 
+	struct CachedElement {
+		QImage frame;
+		TextSelection selection;
+
+		// Item state that is painted, but doesn't go through the
+		// Element view recreation or resize, like outbox read checks.
+		bool unread = false;
+		int views = 0;
+		QString unreadBar;
+	};
+	base::flat_map<not_null<const Element*>, CachedElement> _cachedElements;
+	Core::MediaActiveCache<const Element> _cachedElementsUsage;
+
 };
@@ -75,7 +75,7 @@ struct HistoryMessageForwarded : public RuntimeComponent<HistoryMessageForwarded
 
 	TimeId originalDate = 0;
 	PeerData *originalSender = nullptr;
-	std::unique_ptr<HiddenSenderInfo> hiddenSenderInfo;
+	std::shared_ptr<HiddenSenderInfo> hiddenSenderInfo;
 	QString originalAuthor;
 	QString psaType;
 	MsgId originalId = 0;
@@ -841,7 +841,7 @@ void HistoryMessage::createComponents(const CreateConfig &config) {
 		edited->date = config.editDate;
 	}
 	if (const auto msgsigned = Get<HistoryMessageSigned>()) {
-		msgsigned->author = config.author;
+		msgsigned->author = history()->owner().internedName(config.author);
 	}
 	setupForwardedComponent(config);
 	if (const auto markup = Get<HistoryMessageReplyMarkup>()) {
@@ -868,12 +868,14 @@ void HistoryMessage::setupForwardedComponent(const CreateConfig &config) {
 		? history()->owner().peer(config.senderOriginal).get()
 		: nullptr;
 	if (!forwarded->originalSender) {
-		forwarded->hiddenSenderInfo = std::make_unique<HiddenSenderInfo>(
+		forwarded->hiddenSenderInfo = history()->owner().hiddenSenderInfo(
 			config.senderNameOriginal);
 	}
 	forwarded->originalId = config.originalId;
-	forwarded->originalAuthor = config.authorOriginal;
-	forwarded->psaType = config.forwardPsaType;
+	forwarded->originalAuthor = history()->owner().internedName(
+		config.authorOriginal);
+	forwarded->psaType = history()->owner().internedName(
+		config.forwardPsaType);
 	forwarded->savedFromPeer = history()->owner().peerLoaded(
 		config.savedFromPeer);
 	forwarded->savedFromMsgId = config.savedFromMsgId;
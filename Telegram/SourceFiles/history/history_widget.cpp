@@ -127,6 +127,9 @@ constexpr auto kSaveDraftAnywayTimeout = 5000;
 constexpr auto kSaveCloudDraftIdleTimeout = 14000;
 constexpr auto kRecordingUpdateDelta = crl::time(100);
 constexpr auto kRefreshSlowmodeLabelTimeout = crl::time(200);
+constexpr auto kLazyResizeDelay = crl::time(16);
+constexpr auto kUnloadFarBlocksDelay = crl::time(2000);
+constexpr auto kUnloadFarBlocksHeightsCount = 10;
 constexpr auto kCommonModifiers = 0
 	| Qt::ShiftModifier
 	| Qt::MetaModifier
@@ -350,6 +353,13 @@ HistoryWidget::HistoryWidget(
 	_scrollTimer.setSingleShot(false);
 
 	_highlightTimer.setCallback([this] { updateHighlightedMessage(); });
+	_unloadFarBlocksTimer.setCallback([=] { unloadFarBlocks(); });
+	_lazyResizeTimer.setCallback([=] {
+		if (_list && hasLazyResizedBlocks()) {
+			updateHistoryGeometry();
+			_list->update();
+		}
+	});
 
 	_membersDropdownShowTimer.setSingleShot(true);
 	connect(&_membersDropdownShowTimer, SIGNAL(timeout()), this, SLOT(onMembersDropdownShow()));
@@ -2639,7 +2649,10 @@ void HistoryWidget::loadMessages() {
 			|| _history->loadedAtTop()
 			|| (!_migrated->isEmpty() && !_migrated->loadedAtBottom()));
 	auto from = loadMigrated ? _migrated : _history;
-	if (from->loadedAtTop()) {
+	if (from->restoreUnloadedAbove()) {
+		updateHistoryGeometry();
+		return;
+	} else if (from->loadedAtTop()) {
 		return;
 	}
 
@@ -2797,6 +2810,24 @@ void HistoryWidget::onScroll() {
 	if (!_synteticScrollEvent) {
 		_lastUserScrolled = crl::now();
 	}
+	_unloadFarBlocksTimer.callOnce(kUnloadFarBlocksDelay);
+}
+
+void HistoryWidget::unloadFarBlocks() {
+	if (!_list
+		|| !_historyInited
+		|| _firstLoadRequest
+		|| _delayedShowAtRequest
+		|| _preloadRequest
+		|| _preloadDownRequest
+		|| _scroll->isHidden()) {
+		return;
+	}
+	const auto keep = kUnloadFarBlocksHeightsCount * _scroll->height();
+	if (_list->unloadBlocksAbove(_scroll->scrollTop() - keep)) {
+		updateHistoryGeometry();
+		_list->update();
+	}
 }
 
 bool HistoryWidget::isItemCompletelyHidden(HistoryItem *item) const {
@@ -5251,6 +5282,9 @@ void HistoryWidget::updateHistoryGeometry(
 
 	updateListSize();
 	_updateHistoryGeometryRequired = false;
+	if (hasLazyResizedBlocks()) {
+		_lazyResizeTimer.callOnce(kLazyResizeDelay);
+	}
 
 	auto newScrollTop = 0;
 	if (initial) {
@@ -5297,6 +5331,11 @@ bool HistoryWidget::hasPendingResizedItems() const {
 		|| (_migrated && _migrated->hasPendingResizedItems());
 }
 
+bool HistoryWidget::hasLazyResizedBlocks() const {
+	return (_history && _history->hasLazyResizedBlocks())
+		|| (_migrated && _migrated->hasLazyResizedBlocks());
+}
+
 std::optional<int> HistoryWidget::unreadBarTop() const {
 	const auto bar = [&]() -> HistoryView::Element* {
 		if (const auto bar = _migrated ? _migrated->unreadBar() : nullptr) {
@@ -590,9 +590,11 @@ private:
 
 	void updateHistoryGeometry(bool initial = false, bool loadedDown = false, const ScrollChange &change = { ScrollChangeNone, 0 });
 	void updateListSize();
+	void unloadFarBlocks();
 
 	// Does any of the shown histories has this flag set.
 	bool hasPendingResizedItems() const;
+	bool hasLazyResizedBlocks() const;
 
 	// Counts scrollTop for placing the scroll right at the unread
 	// messages bar, choosing from _history and _migrated unreadBar.
@@ -804,6 +806,9 @@ private:
 	base::Timer _highlightTimer;
 	crl::time _highlightStart = 0;
 
+	base::Timer _lazyResizeTimer;
+	base::Timer _unloadFarBlocksTimer;
+
 	QMap<QPair<not_null<History*>, SendAction::Type>, mtpRequestId> _sendActionRequests;
 	base::Timer _sendActionStopTimer;
 
@@ -1815,6 +1815,16 @@ QRect Message::countGeometry() const {
 		height() - contentTop - marginBottom());
 }
 
+int Message::countBubbleContentWidth(int newWidth) const {
+	auto result = newWidth - (st::msgMargin.left() + st::msgMargin.right());
+	if (hasFromPhoto() && displayRightAction()) {
+		result -= st::msgPhotoSkip;
+	}
+	accumulate_min(result, maxWidth());
+	accumulate_min(result, std::max(st::msgMaxWidth, monospaceMaxWidth()));
+	return result;
+}
+
 int Message::resizeContentGetHeight(int newWidth) {
 	if (isHidden()) {
 		return marginTop() + marginBottom();
@@ -1830,13 +1840,8 @@ int Message::resizeContentGetHeight(int newWidth) {
 	const auto bubble = drawBubble();
 
 	// This code duplicates countGeometry() but also resizes media.
-	auto contentWidth = newWidth - (st::msgMargin.left() + st::msgMargin.right());
-	if (hasFromPhoto() && displayRightAction()) {
-		contentWidth -= st::msgPhotoSkip;
-	}
-	accumulate_min(contentWidth, maxWidth());
+	auto contentWidth = countBubbleContentWidth(newWidth);
 	_bubbleWidthLimit = std::max(st::msgMaxWidth, monospaceMaxWidth());
-	accumulate_min(contentWidth, _bubbleWidthLimit);
 	if (mediaDisplayed) {
 		media->resizeGetHeight(contentWidth);
 		if (media->width() < contentWidth) {
@@ -145,6 +145,7 @@ private:
 
 	void updateMediaInBubbleState();
 	QRect countGeometry() const;
+	int countBubbleContentWidth(int newWidth) const;
 
 	int resizeContentGetHeight(int newWidth);
 	QSize performCountOptimalSize() override;
@@ -280,6 +280,10 @@ void Gif::draw(Painter &p, const QRect &r, TextSelection selection, crl::time ms
 	} else {
 		checkStreamedIsStarted();
 	}
+	if (_streamed) {
+		// Painted even while waiting for the first frame.
+		history()->owner().markPlayingVideoFileShown(_parent);
+	}
 	const auto streamingMode = _streamed || activeRoundPlaying || autoplay;
 	const auto activeOwnPlaying = activeOwnStreamed();
 
@@ -884,6 +888,9 @@ void Gif::drawGrouped(
 	} else {
 		checkStreamedIsStarted();
 	}
+	if (_streamed) {
+		history()->owner().markPlayingVideoFileShown(_parent);
+	}
 	const auto streamingMode = _streamed || autoplay;
 	const auto activeOwnPlaying = activeOwnStreamed();
 
@@ -940,6 +940,7 @@ bool MainWidget::selectingPeer() const {
 }
 
 void MainWidget::removeDialog(Dialogs::Key key) {
+	_updatesBatchDialogs.remove(key);
 	_dialogs->removeDialog(key);
 }
 
@@ -1560,6 +1561,10 @@ bool MainWidget::viewsIncrementFail(const RPCError &error, mtpRequestId req) {
 }
 
 void MainWidget::refreshDialog(Dialogs::Key key) {
+	if (_updatesBatchLevel > 0 && key.entry()->inChatList()) {
+		_updatesBatchDialogs.emplace(key);
+		return;
+	}
 	_dialogs->refreshDialog(key);
 }
 
@@ -2838,7 +2843,24 @@ void MainWidget::feedUpdateVector(
 		}
 		feedUpdate(update);
 	}
+	if (!_updatesBatchLevel) {
+		session().data().sendHistoryChangeNotifications();
+	}
+}
+
+void MainWidget::startUpdatesBatch() {
+	++_updatesBatchLevel;
+}
+
+void MainWidget::finishUpdatesBatch() {
+	Expects(_updatesBatchLevel > 0);
+
+	if (--_updatesBatchLevel > 0) {
+		return;
+	}
+	_dialogs->refreshDialogs(base::take(_updatesBatchDialogs));
 	session().data().sendHistoryChangeNotifications();
+	Notify::peerUpdatedSendDelayed();
 }
 
 void MainWidget::feedMessageIds(const MTPVector<MTPUpdate> &updates) {
@@ -2936,6 +2958,9 @@ void MainWidget::gotChannelDifference(
 
 void MainWidget::feedChannelDifference(
 		const MTPDupdates_channelDifference &data) {
+	startUpdatesBatch();
+	const auto batch = gsl::finally([&] { finishUpdatesBatch(); });
+
 	session().data().processUsers(data.vusers());
 	session().data().processChats(data.vchats());
 
@@ -3086,6 +3111,9 @@ void MainWidget::feedDifference(
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
 		const MTPVector<MTPUpdate> &other) {
+	startUpdatesBatch();
+	const auto batch = gsl::finally([&] { finishUpdatesBatch(); });
+
 	session().checkAutoLock();
 	session().data().processUsers(users);
 	session().data().processChats(chats);
@@ -3713,6 +3741,8 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 			}
 		}
 
+		startUpdatesBatch();
+		const auto batch = gsl::finally([&] { finishUpdatesBatch(); });
 		session().data().processUsers(d.vusers());
 		session().data().processChats(d.vchats());
 		feedUpdateVector(d.vupdates());
@@ -3733,6 +3763,8 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 			}
 		}
 
+		startUpdatesBatch();
+		const auto batch = gsl::finally([&] { finishUpdatesBatch(); });
 		session().data().processUsers(d.vusers());
 		session().data().processChats(d.vchats());
 		feedUpdateVector(d.vupdates());
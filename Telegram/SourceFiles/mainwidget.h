@@ -401,6 +401,11 @@ private:
 	// Doesn't call sendHistoryChangeNotifications itself.
 	void feedUpdate(const MTPUpdate &update);
 
+	// While a batch is applied chats already in the list are not moved,
+	// they are all repositioned once when the outermost batch finishes.
+	void startUpdatesBatch();
+	void finishUpdatesBatch();
+
 	void usernameResolveDone(QPair<MsgId, QString> msgIdAndStartToken, const MTPcontacts_ResolvedPeer &result);
 	bool usernameResolveFail(QString name, const RPCError &error);
 
@@ -525,6 +530,8 @@ private:
 
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
+	int _updatesBatchLevel = 0;
+	base::flat_set<Dialogs::Key> _updatesBatchDialogs;
 
 	QPixmap _cachedBackground;
 	QRect _cachedFor, _willCacheFor;
@@ -1252,6 +1252,7 @@ void Fader::onTimer() {
 
 	auto volumeChangedAll = false;
 	auto volumeChangedSong = false;
+	auto suppressAllSteadyFor = crl::time(0);
 	if (_suppressAll || _suppressSongAnim) {
 		auto ms = crl::now();
 		if (_suppressAll) {
@@ -1266,6 +1267,7 @@ void Fader::onTimer() {
 					_suppressVolumeAll.finish();
 					_suppressAllAnim = false;
 				}
+				suppressAllSteadyFor = _suppressAllEnd - kFadeDuration - ms;
 			} else if (ms > _suppressAllStart) {
 				_suppressVolumeAll.update((ms - _suppressAllStart) / float64(st::mediaPlayerSuppressDuration), anim::linear);
 			}
@@ -1286,7 +1288,12 @@ void Fader::onTimer() {
 		accumulate_min(VolumeMultiplierSong, VolumeMultiplierAll);
 		volumeChangedSong = (VolumeMultiplierSong != wasVolumeMultiplierSong);
 	}
-	auto hasFading = (_suppressAll || _suppressSongAnim);
+	// Nothing changes while all sounds stay suppressed, so there is no
+	// need to wake up each kCheckFadingTimeout until it starts fading out.
+	const auto suppressAllSteady = (suppressAllSteadyFor > 0)
+		&& !_suppressSongAnim;
+	auto hasFading = (_suppressAll || _suppressSongAnim)
+		&& !suppressAllSteady;
 	auto hasPlaying = false;
 
 	auto updatePlayback = [this, &hasPlaying, &hasFading](AudioMsgId::Type type, int index, float64 volumeMultiplier, bool suppressGainChanged) {
@@ -1315,7 +1322,12 @@ void Fader::onTimer() {
 		_timer.start(kCheckFadingTimeout);
 		Audio::StopDetachIfNotUsedSafe();
 	} else if (hasPlaying) {
-		_timer.start(kCheckPlaybackPositionTimeout);
+		_timer.start(suppressAllSteady
+			? std::min(suppressAllSteadyFor, kCheckPlaybackPositionTimeout)
+			: kCheckPlaybackPositionTimeout);
+		Audio::StopDetachIfNotUsedSafe();
+	} else if (suppressAllSteady) {
+		_timer.start(suppressAllSteadyFor);
 		Audio::StopDetachIfNotUsedSafe();
 	} else {
 		Audio::ScheduleDetachIfNotUsedSafe();
@@ -1677,13 +1689,26 @@ public:
 
 		auto fmt = format();
 		auto peak = uint16(0);
-		auto callback = [&](uint16 sample) {
-			accumulate_max(peak, sample);
-			sumbytes += Media::Player::kWaveformSamplesCount;
-			if (sumbytes >= countbytes) {
-				sumbytes -= countbytes;
-				peaks.push_back(peak);
-				peak = 0;
+		const auto step = int64(Media::Player::kWaveformSamplesCount);
+		const auto process = [&](auto sampleType, bytes::const_span bytes) {
+			using SampleType = decltype(sampleType);
+			auto from = reinterpret_cast<const SampleType*>(bytes.data());
+			const auto till = from + (bytes.size() / sizeof(SampleType));
+			while (from != till) {
+				// Find the peak of all the samples till the next waveform
+				// value at once, this loop is simple enough to vectorize.
+				const auto left = (countbytes - sumbytes + step - 1) / step;
+				const auto count = std::min(int64(till - from), left);
+				for (const auto sample : gsl::make_span(from, count)) {
+					peak = std::max(peak, Media::Audio::ReadOneSample(sample));
+				}
+				from += count;
+				sumbytes += count * step;
+				if (sumbytes >= countbytes) {
+					sumbytes -= countbytes;
+					peaks.push_back(peak);
+					peak = 0;
+				}
 			}
 		};
 		while (processed < countbytes) {
@@ -1700,9 +1725,9 @@ public:
 
 			auto sampleBytes = bytes::make_span(buffer);
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+				process(uchar(), sampleBytes);
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				process(int16(), sampleBytes);
 			}
 			processed += sampleSize() * samples;
 		}
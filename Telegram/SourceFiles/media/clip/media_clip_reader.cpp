@@ -807,26 +807,40 @@ void Manager::process() {
 		checkAllReaders = (_readers.size() > _readerPointers.size());
 	}
 
+	// Process the readers that are due in the order of their deadlines,
+	// so that a late frame doesn't wait behind the ones that can wait.
+	auto due = std::vector<Readers::iterator>();
+	for (auto i = _readers.begin(), e = _readers.end(); i != e; ++i) {
+		if (i.value() <= ms) {
+			due.push_back(i);
+		}
+	}
+	ranges::sort(due, std::less<>(), [](Readers::iterator i) {
+		return i.value();
+	});
+	for (const auto i : due) {
+		ReaderPrivate *reader = i.key();
+		ResultHandleState state = handleResult(reader, reader->process(ms), ms);
+		if (state == ResultHandleRemove) {
+			_readers.erase(i);
+			continue;
+		} else if (state == ResultHandleStop) {
+			_processingInThread = nullptr;
+			return;
+		}
+		ms = crl::now();
+		if (reader->_videoPausedAtMs) {
+			i.value() = ms + 86400 * 1000ULL;
+		} else if (reader->_nextFrameWhen && reader->_started) {
+			i.value() = reader->_nextFrameWhen;
+		} else {
+			i.value() = (ms + 86400 * 1000ULL);
+		}
+	}
+
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
-		if (i.value() <= ms) {
-			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
-			if (state == ResultHandleRemove) {
-				i = _readers.erase(i);
-				continue;
-			} else if (state == ResultHandleStop) {
-				_processingInThread = nullptr;
-				return;
-			}
-			ms = crl::now();
-			if (reader->_videoPausedAtMs) {
-				i.value() = ms + 86400 * 1000ULL;
-			} else if (reader->_nextFrameWhen && reader->_started) {
-				i.value() = reader->_nextFrameWhen;
-			} else {
-				i.value() = (ms + 86400 * 1000ULL);
-			}
-		} else if (checkAllReaders) {
+		if (checkAllReaders) {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_capture.h"
 #include "media/streaming/media_streaming_instance.h"
 #include "media/streaming/media_streaming_player.h"
+#include "media/streaming/media_streaming_reader.h"
 #include "media/view/media_view_playback_progress.h"
 #include "calls/calls_instance.h"
 #include "history/history.h"
@@ -44,6 +45,9 @@ constexpr auto kIdsPreloadAfter = 28;
 
 constexpr auto kMinLengthForSavePosition = 20 * TimeId(60); // 20 minutes.
 
+// Start loading the next playlist item when less than that is left.
+constexpr auto kPreloadNextBeforeEnd = 10 * crl::time(1000);
+
 } // namespace
 
 struct Instance::Streamed {
@@ -55,6 +59,7 @@ struct Instance::Streamed {
 	Streaming::Instance instance;
 	View::PlaybackProgress progress;
 	bool clearing = false;
+	bool nextPreloaded = false;
 	rpl::lifetime lifetime;
 };
 
@@ -335,6 +340,53 @@ bool Instance::moveInPlaylist(
 	return false;
 }
 
+void Instance::preloadNextIfNeeded(
+		not_null<Data*> data,
+		crl::time position) {
+	const auto streamed = data->streamed.get();
+	if (!streamed
+		|| streamed->nextPreloaded
+		|| data->repeatEnabled
+		|| !data->playlistIndex
+		|| position == Streaming::kTimeUnknown) {
+		return;
+	}
+	const auto duration = streamed->instance.info().audio.state.duration;
+	if (duration == Streaming::kTimeUnknown
+		|| position + kPreloadNextBeforeEnd < duration) {
+		return;
+	}
+	streamed->nextPreloaded = true;
+
+	// Open the streamed document of the next track in advance and start
+	// loading its first parts, so that it begins right away when the
+	// current one finishes. play() will reuse the same document.
+	if (const auto item = itemByIndex(data, *data->playlistIndex + 1)) {
+		if (const auto media = item->media()) {
+			if (const auto document = media->document()) {
+				if (document->isAudioFile() || document->isVoiceMessage()) {
+					preloadNext(data, document, item->fullId());
+				}
+			}
+		}
+	}
+}
+
+void Instance::preloadNext(
+		not_null<Data*> data,
+		not_null<DocumentData*> document,
+		FullMsgId contextId) {
+	auto &streaming = document->owner().streaming();
+	data->preloadedNext = streaming.sharedDocument(document, contextId);
+	if (!data->preloadedNext) {
+		return;
+	} else if (const auto reader = streaming.sharedReader(
+			document,
+			contextId)) {
+		reader->preloadFirstParts();
+	}
+}
+
 bool Instance::previousAvailable(AudioMsgId::Type type) const {
 	const auto data = getData(type);
 	Assert(data != nullptr);
@@ -420,6 +472,7 @@ void Instance::playStreamed(
 	data->streamed = std::make_unique<Streamed>(
 		audioId,
 		std::move(shared));
+	data->preloadedNext = nullptr;
 	data->streamed->instance.lockPlayer();
 
 	data->streamed->instance.player().updates(
@@ -476,6 +529,7 @@ void Instance::stop(AudioMsgId::Type type) {
 		if (data->streamed) {
 			clearStreamed(data);
 		}
+		data->preloadedNext = nullptr;
 		data->resumeOnCallEnd = false;
 	}
 }
@@ -727,6 +781,7 @@ void Instance::handleStreamingUpdate(
 		//emitUpdate(data->type, [](AudioMsgId) { return true; });
 	}, [&](UpdateAudio &update) {
 		emitUpdate(data->type);
+		preloadNextIfNeeded(data, update.position);
 	}, [&](WaitingForData) {
 	}, [&](MutedByOther) {
 	}, [&](Finished) {
@@ -187,6 +187,7 @@ private:
 		bool isPlaying = false;
 		bool resumeOnCallEnd = false;
 		std::unique_ptr<Streamed> streamed;
+		std::shared_ptr<Streaming::Document> preloadedNext;
 	};
 
 	Instance();
@@ -216,6 +217,11 @@ private:
 	void validatePlaylist(not_null<Data*> data);
 	void playlistUpdated(not_null<Data*> data);
 	bool moveInPlaylist(not_null<Data*> data, int delta, bool autonext);
+	void preloadNextIfNeeded(not_null<Data*> data, crl::time position);
+	void preloadNext(
+		not_null<Data*> data,
+		not_null<DocumentData*> document,
+		FullMsgId contextId);
 	HistoryItem *itemByIndex(not_null<Data*> data, int index);
 
 	void handleStreamingUpdate(
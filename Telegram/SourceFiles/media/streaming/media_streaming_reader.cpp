@@ -25,6 +25,9 @@ constexpr auto kSlicesInMemory = 2;
 
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
+
+// 512 KB of parts are requested from cloud before streaming starts.
+constexpr auto kPreloadFirstParts = 4;
 constexpr auto kDownloaderRequestsLimit = 4;
 
 using PartsMap = base::flat_map<int, QByteArray>;
@@ -410,9 +413,10 @@ void Reader::Slices::applyHeaderCacheData() {
 			if (!predicate(index)) {
 				break;
 			}
-			_data[index].addPart(
-				offset - index * kInSlice,
-				base::duplicate(part));
+			const auto inSlice = offset - index * kInSlice;
+			if (!_data[index].parts.contains(inSlice)) {
+				_data[index].addPart(inSlice, base::duplicate(part));
+			}
 		}
 	};
 	if (_header.parts.empty()) {
@@ -525,9 +529,12 @@ void Reader::Slices::processPart(
 		QByteArray &&bytes) {
 	Expects(isFullInHeader() || (offset / kInSlice < _data.size()));
 
+	// Parts preloaded before streaming could be read from cache as well.
 	if (isFullInHeader()) {
-		_header.addPart(offset, bytes);
-		checkSliceFullLoaded(0);
+		if (!_header.parts.contains(offset)) {
+			_header.addPart(offset, bytes);
+			checkSliceFullLoaded(0);
+		}
 		return;
 	} else if (_headerMode == HeaderMode::Unknown) {
 		if (_header.parts.contains(offset)) {
@@ -537,7 +544,11 @@ void Reader::Slices::processPart(
 		}
 	}
 	const auto index = offset / kInSlice;
-	_data[index].addPart(offset - index * kInSlice, std::move(bytes));
+	const auto inSlice = offset - index * kInSlice;
+	if (_data[index].parts.contains(inSlice)) {
+		return;
+	}
+	_data[index].addPart(inSlice, std::move(bytes));
 	checkSliceFullLoaded(index + 1);
 }
 
@@ -856,7 +867,7 @@ Reader::Reader(
 		if (_attachedDownloader) {
 			_partsForDownloader.fire_copy(part);
 		}
-		if (_streamingActive) {
+		if (_streamingActive || _preloadActive) {
 			_loadedParts.emplace(std::move(part));
 		}
 		if (const auto waiting = _waiting.load(std::memory_order_acquire)) {
@@ -911,12 +922,27 @@ void Reader::stopStreaming(bool stillActive) {
 	_waiting.store(nullptr, std::memory_order_release);
 	if (!stillActive) {
 		_streamingActive = false;
+		_preloadActive = false;
 		refreshLoaderPriority();
 		_loadingOffsets.clear();
 		processDownloaderRequests();
 	}
 }
 
+void Reader::preloadFirstParts() {
+	if (_streamingActive || _preloadActive || !isRemoteLoader()) {
+		return;
+	}
+
+	// Loaded parts wait in the queue until the streaming thread takes
+	// them, the same way as the parts loaded while it sleeps.
+	_preloadActive = true;
+	const auto till = std::min(size(), kPreloadFirstParts * kPartSize);
+	for (auto offset = 0; offset < till; offset += kPartSize) {
+		loadAtOffset(offset);
+	}
+}
+
 rpl::producer<LoadedPart> Reader::partsForDownloader() const {
 	return _partsForDownloader.events();
 }
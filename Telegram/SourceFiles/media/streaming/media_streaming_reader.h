@@ -63,6 +63,7 @@ public:
 	// Main thread.
 	void startStreaming();
 	void stopStreaming(bool stillActive = false);
+	void preloadFirstParts();
 	[[nodiscard]] rpl::producer<LoadedPart> partsForDownloader() const;
 	void loadForDownloader(
 		not_null<Storage::StreamedFileDownloader*> downloader,
@@ -251,6 +252,7 @@ private:
 	rpl::event_stream<LoadedPart> _partsForDownloader;
 	int _realPriority = 1;
 	bool _streamingActive = false;
+	bool _preloadActive = false;
 
 	// Streaming thread.
 	std::deque<int> _offsetsForDownloader;
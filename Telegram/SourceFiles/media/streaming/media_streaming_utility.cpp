@@ -17,6 +17,33 @@ namespace {
 
 constexpr auto kSkipInvalidDataPackets = 10;
 
+void CopyFramePixels(QImage &storage, const QImage &original) {
+	Expects(storage.size() == original.size());
+	Expects(storage.format() == original.format());
+
+	const auto bytesPerLine = original.width() * FFmpeg::kPixelBytesSize;
+	const auto perLineTo = storage.bytesPerLine();
+	const auto perLineFrom = original.bytesPerLine();
+	if (perLineTo == perLineFrom) {
+		memcpy(
+			storage.bits(),
+			original.constBits(),
+#if QT_VERSION < QT_VERSION_CHECK(5, 10, 0)
+			original.byteCount());
+#else // Qt < 5.10.0
+			original.sizeInBytes());
+#endif // Qt >= 5.10.0
+		return;
+	}
+	auto to = storage.bits();
+	auto from = original.constBits();
+	for (auto y = 0, height = original.height(); y != height; ++y) {
+		memcpy(to, from, bytesPerLine);
+		to += perLineTo;
+		from += perLineFrom;
+	}
+}
+
 } // namespace
 
 crl::time FramePosition(const Stream &stream) {
@@ -291,9 +318,21 @@ QImage PrepareByRequest(
 		storage = FFmpeg::CreateFrameStorage(outer);
 	}
 
-	QPainter p(&storage);
-	PaintFrameContent(p, original, alpha, rotation, request);
-	p.end();
+	const auto size = request.resize.isEmpty()
+		? original.size()
+		: request.resize;
+	if (!alpha
+		&& !rotation
+		&& (size == outer)
+		&& (original.size() == outer)
+		&& (original.format() == storage.format())) {
+		// The frame was already scaled by ConvertFrame(), only rounding
+		// is left, so skip the painter pass and copy the pixels as is.
+		CopyFramePixels(storage, original);
+	} else {
+		QPainter p(&storage);
+		PaintFrameContent(p, original, alpha, rotation, request);
+	}
 
 	ApplyFrameRounding(storage, request);
 	return storage;
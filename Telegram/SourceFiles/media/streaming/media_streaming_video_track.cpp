@@ -17,6 +17,7 @@ namespace {
 constexpr auto kMaxFrameArea = 3840 * 2160; // usual 4K
 constexpr auto kDisplaySkipped = crl::time(-1);
 constexpr auto kFinishedPosition = std::numeric_limits<crl::time>::max();
+constexpr auto kSkipNonReferenceMargin = crl::time(100);
 static_assert(kDisplaySkipped != kTimeUnknown);
 
 } // namespace
@@ -478,6 +479,19 @@ void VideoTrackObject::removeFrameRequest(const Instance *instance) {
 }
 
 bool VideoTrackObject::tryReadFirstFrame(FFmpeg::Packet &&packet) {
+	// Frames well before the seek position are decoded only to be skipped,
+	// so the ones no other frame references are not decoded at all.
+	// Packets near the position are decoded fully, because the frame we
+	// show may be a non-reference one.
+	const auto &fields = packet.fields();
+	const auto pts = (fields.pts != AV_NOPTS_VALUE) ? fields.pts : fields.dts;
+	const auto skipNonReference = (_options.position > 0)
+		&& (pts != AV_NOPTS_VALUE)
+		&& (FFmpeg::PtsToTime(pts + fields.duration, _stream.timeBase)
+			+ kSkipNonReferenceMargin < _options.position);
+	_stream.codec->skip_frame = skipNonReference
+		? AVDISCARD_NONREF
+		: AVDISCARD_DEFAULT;
 	if (ProcessPacket(_stream, std::move(packet)).failed()) {
 		return false;
 	}
@@ -512,6 +526,7 @@ bool VideoTrackObject::tryReadFirstFrame(FFmpeg::Packet &&packet) {
 }
 
 bool VideoTrackObject::processFirstFrame() {
+	_stream.codec->skip_frame = AVDISCARD_DEFAULT;
 	if (_stream.frame->width * _stream.frame->height > kMaxFrameArea) {
 		return false;
 	}
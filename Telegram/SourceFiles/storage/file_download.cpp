@@ -91,7 +91,7 @@ QImage FileLoader::imageData(const QSize &shrinkBox) const {
 
 void FileLoader::readImage(const QSize &shrinkBox) const {
 	auto format = QByteArray();
-	auto image = App::readImage(_data, &format, false);
+	auto image = App::readImage(_data, &format, false, nullptr, shrinkBox);
 	if (!image.isNull()) {
 		if (!shrinkBox.isEmpty() && (image.width() > shrinkBox.width() || image.height() > shrinkBox.height())) {
 			_imageData = image.scaled(shrinkBox, Qt::KeepAspectRatio, Qt::SmoothTransformation);
@@ -186,7 +186,8 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
-	session().data().cache().get(key, [=, callback = std::move(done)](
+	auto &cache = session().data().cacheForTag(_cacheTag);
+	cache.get(key, [=, callback = std::move(done)](
 			QByteArray &&value) mutable {
 		if (readImage) {
 			crl::async([
@@ -361,7 +362,7 @@ bool FileLoader::finalizeResult() {
 		}
 		if ((_toCache == LoadToCacheAsWell)
 			&& (_data.size() <= Storage::kMaxFileInMemory)) {
-			session().data().cache().put(
+			session().data().cacheForTag(_cacheTag).put(
 				cacheKey(),
 				Storage::Cache::Database::TaggedValue(
 					base::duplicate(_data),
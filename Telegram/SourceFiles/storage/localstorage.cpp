@@ -52,6 +52,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 extern "C" {
 #include <openssl/evp.h>
+#include <openssl/sha.h>
 } // extern "C"
 
 namespace Local {
@@ -62,6 +63,9 @@ constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 constexpr auto kProxyTypeShift = 1024;
 constexpr auto kWriteMapTimeout = crl::time(1000);
+constexpr auto kMaintenanceDelay = 5 * 60 * crl::time(1000);
+constexpr auto kMaintenanceStepTimeout = crl::time(500);
+constexpr auto kMaintenanceFilesPerStep = 4;
 constexpr auto kSavedBackgroundFormat = QImage::Format_ARGB32_Premultiplied;
 
 constexpr auto kWallPaperLegacySerializeTagId = int32(-111);
@@ -75,7 +79,8 @@ constexpr auto kSinglePeerTypeSelf = qint32(4);
 constexpr auto kSinglePeerTypeEmpty = qint32(0);
 
 constexpr auto kStickersVersionTag = quint32(-1);
-constexpr auto kStickersSerializeVersion = 1;
+constexpr auto kStickersSerializeVersion = 2;
+constexpr auto kStickersSerializeVersionInline = 1;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
 
 const auto kThemeNewPathRelativeTag = qstr("special://new_tag");
@@ -186,21 +191,88 @@ auto SettingsKey = MTP::AuthKeyPtr();
 auto PassKey = MTP::AuthKeyPtr();
 auto LocalKey = MTP::AuthKeyPtr();
 
+enum class LocalKeyVersion : quint32 {
+	Legacy = 0, // PBKDF2-HMAC-SHA1, LocalEncryptIterCount iterations.
+	Strong = 1, // PBKDF2-HMAC-SHA512 over SHA512(salt + pass + salt).
+};
+
+constexpr auto kStrongIterationsCount = 100'000;
+
+auto PassKeyVersion = LocalKeyVersion::Legacy;
+
+// Older versions ignore the key version stored in the map and always
+// derive the Legacy key, so the Strong one protects only an actual
+// passcode. Without a passcode the map stays readable after a downgrade,
+// with a passcode it has to be removed before downgrading.
+[[nodiscard]] LocalKeyVersion PassKeyVersionFor(const QByteArray &pass) {
+	return pass.isEmpty() ? LocalKeyVersion::Legacy : LocalKeyVersion::Strong;
+}
+
+[[nodiscard]] MTP::AuthKeyPtr CreateLocalKey(
+		const QByteArray &pass,
+		const QByteArray &salt,
+		LocalKeyVersion version) {
+	auto key = MTP::AuthKey::Data{ { gsl::byte{} } };
+	if (version == LocalKeyVersion::Legacy) {
+		const auto iterCount = pass.size()
+			? LocalEncryptIterCount
+			: LocalEncryptNoPwdIterCount; // dont slow down for no password
+		PKCS5_PBKDF2_HMAC_SHA1(
+			pass.constData(),
+			pass.size(),
+			(const uchar*)salt.constData(),
+			salt.size(),
+			iterCount,
+			key.size(),
+			(uchar*)key.data());
+	} else {
+		auto hash = std::array<uchar, SHA512_DIGEST_LENGTH>();
+		SHA512_CTX context;
+		SHA512_Init(&context);
+		SHA512_Update(&context, salt.constData(), salt.size());
+		SHA512_Update(&context, pass.constData(), pass.size());
+		SHA512_Update(&context, salt.constData(), salt.size());
+		SHA512_Final(hash.data(), &context);
+
+		const auto iterCount = pass.isEmpty()
+			? 1 // Don't slow down for no password.
+			: kStrongIterationsCount;
+		PKCS5_PBKDF2_HMAC(
+			(const char*)hash.data(),
+			hash.size(),
+			(const uchar*)salt.constData(),
+			salt.size(),
+			iterCount,
+			EVP_sha512(),
+			key.size(),
+			(uchar*)key.data());
+	}
+	return std::make_shared<MTP::AuthKey>(key);
+}
+
 void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *result) {
-	auto key = MTP::AuthKey::Data { { gsl::byte{} } };
-	auto iterCount = pass.size() ? LocalEncryptIterCount : LocalEncryptNoPwdIterCount; // dont slow down for no password
-	auto newSalt = QByteArray();
-	if (!salt) {
-		newSalt.resize(LocalEncryptSaltSize);
-		memset_rand(newSalt.data(), newSalt.size());
-		salt = &newSalt;
+	Expects(salt != nullptr);
 
-		cSetLocalSalt(newSalt);
-	}
+	*result = CreateLocalKey(pass, *salt, LocalKeyVersion::Legacy);
+}
 
-	PKCS5_PBKDF2_HMAC_SHA1(pass.constData(), pass.size(), (uchar*)salt->data(), salt->size(), iterCount, key.size(), (uchar*)key.data());
+[[nodiscard]] QByteArray SerializeKeyVersion(LocalKeyVersion version) {
+	auto result = QByteArray(sizeof(quint32), Qt::Uninitialized);
+	qToBigEndian(quint32(version), result.data());
+	return result;
+}
 
-	*result = std::make_shared<MTP::AuthKey>(key);
+[[nodiscard]] std::optional<LocalKeyVersion> DeserializeKeyVersion(
+		const QByteArray &serialized) {
+	if (serialized.size() != sizeof(quint32)) {
+		return std::nullopt;
+	}
+	const auto value = qFromBigEndian<quint32>(serialized.constData());
+	switch (static_cast<LocalKeyVersion>(value)) {
+	case LocalKeyVersion::Legacy:
+	case LocalKeyVersion::Strong: return static_cast<LocalKeyVersion>(value);
+	}
+	return std::nullopt;
 }
 
 struct FileReadDescriptor {
@@ -429,6 +501,59 @@ void FileWriteDescriptor::finish() {
 	}
 }
 
+// May be called from any thread, checks only the magic and the signature.
+[[nodiscard]] bool ReadSignedFile(
+		const QString &path,
+		const QString &name,
+		QByteArray &data,
+		qint32 &version) {
+	QFile f(path);
+	if (!f.open(QIODevice::ReadOnly)) {
+		DEBUG_LOG(("App Info: failed to open '%1' for reading").arg(name));
+		return false;
+	}
+
+	// check magic
+	char magic[tdfMagicLen];
+	if (f.read(magic, tdfMagicLen) != tdfMagicLen) {
+		DEBUG_LOG(("App Info: failed to read magic from '%1'").arg(name));
+		return false;
+	}
+	if (memcmp(magic, tdfMagic, tdfMagicLen)) {
+		DEBUG_LOG(("App Info: bad magic %1 in '%2'").arg(Logs::mb(magic, tdfMagicLen).str()).arg(name));
+		return false;
+	}
+
+	// read app version
+	if (f.read((char*)&version, sizeof(version)) != sizeof(version)) {
+		DEBUG_LOG(("App Info: failed to read version from '%1'").arg(name));
+		return false;
+	}
+
+	// read data
+	QByteArray bytes = f.read(f.size());
+	int32 dataSize = bytes.size() - 16;
+	if (dataSize < 0) {
+		DEBUG_LOG(("App Info: bad file '%1', could not read sign part").arg(name));
+		return false;
+	}
+
+	// check signature
+	HashMd5 md5;
+	md5.feed(bytes.constData(), dataSize);
+	md5.feed(&dataSize, sizeof(dataSize));
+	md5.feed(&version, sizeof(version));
+	md5.feed(magic, tdfMagicLen);
+	if (memcmp(md5.result(), bytes.constData() + dataSize, 16)) {
+		DEBUG_LOG(("App Info: bad file '%1', signature did not match").arg(name));
+		return false;
+	}
+
+	bytes.resize(dataSize);
+	data = std::move(bytes);
+	return true;
+}
+
 bool ReadFile(
 		FileReadDescriptor &result,
 		const QString &name,
@@ -469,54 +594,15 @@ bool ReadFile(
 		QString fname(toTry[i]);
 		if (fname.isEmpty()) break;
 
-		QFile f(fname);
-		if (!f.open(QIODevice::ReadOnly)) {
-			DEBUG_LOG(("App Info: failed to open '%1' for reading").arg(name));
-			continue;
-		}
-
-		// check magic
-		char magic[tdfMagicLen];
-		if (f.read(magic, tdfMagicLen) != tdfMagicLen) {
-			DEBUG_LOG(("App Info: failed to read magic from '%1'").arg(name));
-			continue;
-		}
-		if (memcmp(magic, tdfMagic, tdfMagicLen)) {
-			DEBUG_LOG(("App Info: bad magic %1 in '%2'").arg(Logs::mb(magic, tdfMagicLen).str()).arg(name));
+		auto bytes = QByteArray();
+		auto version = qint32();
+		if (!ReadSignedFile(fname, name, bytes, version)) {
 			continue;
-		}
-
-		// read app version
-		qint32 version;
-		if (f.read((char*)&version, sizeof(version)) != sizeof(version)) {
-			DEBUG_LOG(("App Info: failed to read version from '%1'").arg(name));
-			continue;
-		}
-		if (version > AppVersion) {
+		} else if (version > AppVersion) {
 			DEBUG_LOG(("App Info: version too big %1 for '%2', my version %3").arg(version).arg(name).arg(AppVersion));
 			continue;
 		}
 
-		// read data
-		QByteArray bytes = f.read(f.size());
-		int32 dataSize = bytes.size() - 16;
-		if (dataSize < 0) {
-			DEBUG_LOG(("App Info: bad file '%1', could not read sign part").arg(name));
-			continue;
-		}
-
-		// check signature
-		HashMd5 md5;
-		md5.feed(bytes.constData(), dataSize);
-		md5.feed(&dataSize, sizeof(dataSize));
-		md5.feed(&version, sizeof(version));
-		md5.feed(magic, tdfMagicLen);
-		if (memcmp(md5.result(), bytes.constData() + dataSize, 16)) {
-			DEBUG_LOG(("App Info: bad file '%1', signature did not match").arg(name));
-			continue;
-		}
-
-		bytes.resize(dataSize);
 		result.data = bytes;
 		bytes = QByteArray();
 
@@ -2333,8 +2419,22 @@ void _readMtpData() {
 	applyReadContext(std::move(context));
 }
 
-ReadMapState _readMap(const QByteArray &pass) {
-	auto ms = crl::now();
+struct MapHeader {
+	int32 version = 0;
+	QByteArray salt;
+	QByteArray keyEncrypted;
+	QByteArray mapEncrypted;
+	LocalKeyVersion keyVersion = LocalKeyVersion::Legacy;
+};
+
+struct PassKeys {
+	MTP::AuthKeyPtr stored;
+	MTP::AuthKeyPtr upgraded;
+	QByteArray upgradedSalt;
+	LocalKeyVersion upgradedVersion = LocalKeyVersion::Legacy;
+};
+
+std::optional<MapHeader> _readMapHeader() {
 	QByteArray dataNameUtf8 = (cDataFile() + (cTestMode() ? qsl(":/test/") : QString())).toUtf8();
 	FileKey dataNameHash[2];
 	hashMd5(dataNameUtf8.constData(), dataNameUtf8.size(), dataNameHash);
@@ -2347,24 +2447,64 @@ ReadMapState _readMap(const QByteArray &pass) {
 
 	FileReadDescriptor mapData;
 	if (!ReadFile(mapData, qsl("map"))) {
-		return ReadMapFailed;
+		return std::nullopt;
 	}
 	LOG(("App Info: reading map..."));
 
-	QByteArray salt, keyEncrypted, mapEncrypted;
-	mapData.stream >> salt >> keyEncrypted >> mapEncrypted;
+	auto result = MapHeader();
+	result.version = mapData.version;
+	mapData.stream >> result.salt >> result.keyEncrypted >> result.mapEncrypted;
 	if (!_checkStreamStatus(mapData.stream)) {
-		return ReadMapFailed;
+		return std::nullopt;
+	}
+	if (!mapData.stream.atEnd()) {
+		QByteArray keyVersionSerialized;
+		mapData.stream >> keyVersionSerialized;
+		const auto keyVersion = DeserializeKeyVersion(keyVersionSerialized);
+		if (!_checkStreamStatus(mapData.stream) || !keyVersion) {
+			LOG(("App Error: bad key version in map file."));
+			return std::nullopt;
+		}
+		result.keyVersion = *keyVersion;
 	}
 
-	if (salt.size() != LocalEncryptSaltSize) {
-		LOG(("App Error: bad salt in map file, size: %1").arg(salt.size()));
-		return ReadMapFailed;
+	if (result.salt.size() != LocalEncryptSaltSize) {
+		LOG(("App Error: bad salt in map file, size: %1"
+			).arg(result.salt.size()));
+		return std::nullopt;
+	}
+	return result;
+}
+
+// May be called from any thread, doesn't touch the global state.
+[[nodiscard]] PassKeys DerivePassKeys(
+		const QByteArray &pass,
+		const MapHeader &header) {
+	auto result = PassKeys();
+	result.stored = CreateLocalKey(pass, header.salt, header.keyVersion);
+	const auto version = PassKeyVersionFor(pass);
+	if (header.keyVersion == version) {
+		return result;
 	}
-	createLocalKey(pass, &salt, &PassKey);
+
+	// Don't spend time on the new key if the passcode is wrong anyway.
+	EncryptedDescriptor check;
+	if (decryptLocal(check, header.keyEncrypted, result.stored)) {
+		result.upgradedSalt = QByteArray(
+			LocalEncryptSaltSize,
+			Qt::Uninitialized);
+		memset_rand(result.upgradedSalt.data(), result.upgradedSalt.size());
+		result.upgraded = CreateLocalKey(pass, result.upgradedSalt, version);
+		result.upgradedVersion = version;
+	}
+	return result;
+}
+
+ReadMapState _readMap(const MapHeader &header, const PassKeys &keys) {
+	auto ms = crl::now();
 
 	EncryptedDescriptor keyData, map;
-	if (!decryptLocal(keyData, keyEncrypted, PassKey)) {
+	if (!decryptLocal(keyData, header.keyEncrypted, keys.stored)) {
 		LOG(("App Info: could not decrypt pass-protected key from map file, maybe bad password..."));
 		return ReadMapPassNeeded;
 	}
@@ -2375,10 +2515,24 @@ ReadMapState _readMap(const QByteArray &pass) {
 	}
 	LocalKey = std::make_shared<MTP::AuthKey>(key);
 
-	_passKeyEncrypted = keyEncrypted;
-	_passKeySalt = salt;
+	const auto upgradePassKey = (keys.upgraded != nullptr);
+	if (upgradePassKey) {
+		LOG(("App Info: changing pass-protected key derivation."));
+		PassKey = keys.upgraded;
+		PassKeyVersion = keys.upgradedVersion;
+		_passKeySalt = keys.upgradedSalt;
 
-	if (!decryptLocal(map, mapEncrypted)) {
+		EncryptedDescriptor passKeyData(kLocalKeySize);
+		LocalKey->write(passKeyData.stream);
+		_passKeyEncrypted = PrepareEncrypted(passKeyData, PassKey);
+	} else {
+		PassKey = keys.stored;
+		PassKeyVersion = header.keyVersion;
+		_passKeyEncrypted = header.keyEncrypted;
+		_passKeySalt = header.salt;
+	}
+
+	if (!decryptLocal(map, header.mapEncrypted)) {
 		LOG(("App Error: could not decrypt map."));
 		return ReadMapFailed;
 	}
@@ -2511,8 +2665,8 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_userSettingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
 	_exportSettingsKey = exportSettingsKey;
-	_oldMapVersion = mapData.version;
-	if (_oldMapVersion < AppVersion) {
+	_oldMapVersion = header.version;
+	if (_oldMapVersion < AppVersion || upgradePassKey) {
 		_mapChanged = true;
 		_writeMap();
 	} else {
@@ -2539,6 +2693,14 @@ ReadMapState _readMap(const QByteArray &pass) {
 	return ReadMapDone;
 }
 
+ReadMapState _readMap(const QByteArray &pass) {
+	const auto header = _readMapHeader();
+	if (!header) {
+		return ReadMapFailed;
+	}
+	return _readMap(*header, DerivePassKeys(pass, *header));
+}
+
 void _writeMap(WriteMapWhen when) {
 	Expects(_manager != nullptr);
 
@@ -2557,14 +2719,14 @@ void _writeMap(WriteMapWhen when) {
 
 	FileWriteDescriptor map(qsl("map"));
 	if (_passKeySalt.isEmpty() || _passKeyEncrypted.isEmpty()) {
-		QByteArray pass(kLocalKeySize, Qt::Uninitialized), salt(LocalEncryptSaltSize, Qt::Uninitialized);
-		memset_rand(pass.data(), pass.size());
-		memset_rand(salt.data(), salt.size());
-		createLocalKey(pass, &salt, &LocalKey);
+		auto key = MTP::AuthKey::Data{ { gsl::byte{} } };
+		memset_rand(key.data(), key.size());
+		LocalKey = std::make_shared<MTP::AuthKey>(key);
 
 		_passKeySalt.resize(LocalEncryptSaltSize);
 		memset_rand(_passKeySalt.data(), _passKeySalt.size());
-		createLocalKey(QByteArray(), &_passKeySalt, &PassKey);
+		PassKeyVersion = PassKeyVersionFor(QByteArray());
+		PassKey = CreateLocalKey(QByteArray(), _passKeySalt, PassKeyVersion);
 
 		EncryptedDescriptor passKeyData(kLocalKeySize);
 		LocalKey->write(passKeyData.stream);
@@ -2663,10 +2825,26 @@ void _writeMap(WriteMapWhen when) {
 		mapData.stream << quint32(lskExportSettings) << quint64(_exportSettingsKey);
 	}
 	map.writeEncrypted(mapData);
+	map.writeData(SerializeKeyVersion(PassKeyVersion));
 
 	_mapChanged = false;
 }
 
+void ApplyPasscodeKey(const QByteArray &passcode, MTP::AuthKeyPtr key) {
+	PassKeyVersion = PassKeyVersionFor(passcode);
+	PassKey = std::move(key);
+
+	EncryptedDescriptor passKeyData(kLocalKeySize);
+	LocalKey->write(passKeyData.stream);
+	_passKeyEncrypted = PrepareEncrypted(passKeyData, PassKey);
+
+	_mapChanged = true;
+	_writeMap(WriteMapWhen::Now);
+
+	Global::SetLocalPasscode(!passcode.isEmpty());
+	Global::RefLocalPasscodeChanged().notify();
+}
+
 } // namespace
 
 void finish() {
@@ -2945,24 +3123,46 @@ void reset() {
 	_writeMtpData();
 }
 
-bool checkPasscode(const QByteArray &passcode) {
-	auto checkKey = MTP::AuthKeyPtr();
-	createLocalKey(passcode, &_passKeySalt, &checkKey);
-	return checkKey->equals(PassKey);
+void checkPasscodeAsync(
+		const QByteArray &passcode,
+		FnMut<void(bool)> done) {
+	crl::async([
+		=,
+		salt = _passKeySalt,
+		version = PassKeyVersion,
+		passKey = PassKey,
+		done = std::move(done)
+	]() mutable {
+		const auto checkKey = CreateLocalKey(passcode, salt, version);
+		const auto correct = checkKey->equals(passKey);
+		crl::on_main([=, done = std::move(done)]() mutable {
+			done(correct);
+		});
+	});
 }
 
-void setPasscode(const QByteArray &passcode) {
-	createLocalKey(passcode, &_passKeySalt, &PassKey);
-
-	EncryptedDescriptor passKeyData(kLocalKeySize);
-	LocalKey->write(passKeyData.stream);
-	_passKeyEncrypted = PrepareEncrypted(passKeyData, PassKey);
-
-	_mapChanged = true;
-	_writeMap(WriteMapWhen::Now);
-
-	Global::SetLocalPasscode(!passcode.isEmpty());
-	Global::RefLocalPasscodeChanged().notify();
+void setPasscodeAsync(const QByteArray &passcode, FnMut<void()> done) {
+	crl::async([
+		=,
+		salt = _passKeySalt,
+		done = std::move(done)
+	]() mutable {
+		auto key = CreateLocalKey(
+			passcode,
+			salt,
+			PassKeyVersionFor(passcode));
+		crl::on_main([
+			=,
+			key = std::move(key),
+			done = std::move(done)
+		]() mutable {
+			if (!_manager || _passKeySalt != salt) {
+				return;
+			}
+			ApplyPasscodeKey(passcode, std::move(key));
+			done();
+		});
+	});
 }
 
 base::flat_set<QString> CollectGoodNames() {
@@ -3012,8 +3212,7 @@ void FilterLegacyFiles(FnMut<void(base::flat_set<QString>&&)> then) {
 	});
 }
 
-ReadMapState readMap(const QByteArray &pass) {
-	ReadMapState result = _readMap(pass);
+ReadMapState FinishReadMap(ReadMapState result) {
 	if (result == ReadMapFailed) {
 		_mapChanged = true;
 		_writeMap(WriteMapWhen::Now);
@@ -3021,9 +3220,43 @@ ReadMapState readMap(const QByteArray &pass) {
 	if (result != ReadMapPassNeeded) {
 		Storage::ClearLegacyFiles(_userBasePath, FilterLegacyFiles);
 	}
+	if (result == ReadMapDone) {
+		_manager->scheduleMaintenance();
+	}
 	return result;
 }
 
+ReadMapState readMap(const QByteArray &pass) {
+	return FinishReadMap(_readMap(pass));
+}
+
+void readMapAsync(
+		const QByteArray &pass,
+		FnMut<void(ReadMapState)> done) {
+	auto header = _readMapHeader();
+	if (!header) {
+		done(FinishReadMap(ReadMapFailed));
+		return;
+	}
+	crl::async([
+		=,
+		header = std::move(*header),
+		done = std::move(done)
+	]() mutable {
+		auto keys = DerivePassKeys(pass, header);
+		crl::on_main([
+			header = std::move(header),
+			keys = std::move(keys),
+			done = std::move(done)
+		]() mutable {
+			if (!_manager) {
+				return;
+			}
+			done(FinishReadMap(_readMap(header, keys)));
+		});
+	});
+}
+
 int32 oldMapVersion() {
 	return _oldMapVersion;
 }
@@ -3425,6 +3658,25 @@ void cancelTask(TaskId id) {
 	}
 }
 
+[[nodiscard]] uint32 _stickerSetContentSize(const Stickers::Set &set) {
+	auto result = uint32(0);
+	for (const auto sticker : set.stickers) {
+		result += Serialize::Document::sizeInStream(sticker);
+	}
+
+	result += sizeof(qint32); // datesCount
+	if (!set.dates.empty()) {
+		Assert(set.stickers.size() == set.dates.size());
+		result += set.dates.size() * sizeof(qint32);
+	}
+
+	result += sizeof(qint32); // emojiCount
+	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+		result += Serialize::stringSize(j.key()->id()) + sizeof(qint32) + (j->size() * sizeof(quint64));
+	}
+	return result;
+}
+
 void _writeStickerSet(QDataStream &stream, const Stickers::Set &set) {
 	const auto writeInfo = [&](int count) {
 		stream
@@ -3448,23 +3700,37 @@ void _writeStickerSet(QDataStream &stream, const Stickers::Set &set) {
 	}
 
 	writeInfo(set.stickers.size());
-	for (const auto &sticker : set.stickers) {
-		Serialize::Document::writeToStream(stream, sticker);
-	}
-	stream << qint32(set.dates.size());
-	if (!set.dates.empty()) {
-		Assert(set.dates.size() == set.stickers.size());
-		for (const auto date : set.dates) {
-			stream << qint32(date);
+
+	// Stickers, dates and emoji are written as a single length-prefixed
+	// block, so that the reader can skip sets it already has in memory
+	// without constructing every document.
+	auto content = QByteArray();
+	content.reserve(_stickerSetContentSize(set));
+	{
+		QBuffer buffer(&content);
+		buffer.open(QIODevice::WriteOnly);
+		QDataStream contentStream(&buffer);
+		contentStream.setVersion(QDataStream::Qt_5_1);
+
+		for (const auto &sticker : set.stickers) {
+			Serialize::Document::writeToStream(contentStream, sticker);
 		}
-	}
-	stream << qint32(set.emoji.size());
-	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
-		stream << j.key()->id() << qint32(j->size());
-		for (const auto sticker : *j) {
-			stream << quint64(sticker->id);
+		contentStream << qint32(set.dates.size());
+		if (!set.dates.empty()) {
+			Assert(set.dates.size() == set.stickers.size());
+			for (const auto date : set.dates) {
+				contentStream << qint32(date);
+			}
+		}
+		contentStream << qint32(set.emoji.size());
+		for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+			contentStream << j.key()->id() << qint32(j->size());
+			for (const auto sticker : *j) {
+				contentStream << quint64(sticker->id);
+			}
 		}
 	}
+	stream << content;
 }
 
 // In generic method _writeStickerSets() we look through all the sets and call a
@@ -3517,19 +3783,10 @@ void _writeStickerSets(FileKey &stickersKey, CheckSet checkSet, const Stickers::
 
 		for (const auto sticker : set.stickers) {
 			sticker->refreshStickerThumbFileReference();
-			size += Serialize::Document::sizeInStream(sticker);
 		}
 
-		size += sizeof(qint32); // datesCount
-		if (!set.dates.empty()) {
-			Assert(set.stickers.size() == set.dates.size());
-			size += set.dates.size() * sizeof(qint32);
-		}
-
-		size += sizeof(qint32); // emojiCount
-		for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
-			size += Serialize::stringSize(j.key()->id()) + sizeof(qint32) + (j->size() * sizeof(quint64));
-		}
+		// contentLength + content
+		size += sizeof(quint32) + _stickerSetContentSize(set);
 
 		++setsCount;
 	}
@@ -3590,10 +3847,12 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 	qint32 version = 0;
 	stickers.stream >> versionTag >> version;
 	if (versionTag != kStickersVersionTag
-		|| version != kStickersSerializeVersion) {
+		|| (version != kStickersSerializeVersion
+			&& version != kStickersSerializeVersionInline)) {
 		// Old data, without sticker set thumbnails.
 		return failed();
 	}
+	const auto contentInline = (version == kStickersSerializeVersionInline);
 	qint32 count = 0;
 	stickers.stream >> count;
 	if (!_checkStreamStatus(stickers.stream)
@@ -3680,6 +3939,24 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 			continue;
 		}
 
+		auto content = QByteArray();
+		auto contentBuffer = QBuffer();
+		auto contentStream = QDataStream();
+		if (!contentInline) {
+			stickers.stream >> content;
+			if (!_checkStreamStatus(stickers.stream)) {
+				return failed();
+			} else if (!fillStickers && set.id != Stickers::CloudRecentSetId) {
+				// We already have this set, no need to parse the documents.
+				continue;
+			}
+			contentBuffer.setBuffer(&content);
+			contentBuffer.open(QIODevice::ReadOnly);
+			contentStream.setDevice(&contentBuffer);
+			contentStream.setVersion(QDataStream::Qt_5_1);
+		}
+		auto &stream = contentInline ? stickers.stream : contentStream;
+
 		if (fillStickers) {
 			set.stickers.reserve(scnt);
 			set.count = 0;
@@ -3688,8 +3965,8 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 		Serialize::Document::StickerSetInfo info(setId, setAccess, setShortName);
 		base::flat_set<DocumentId> read;
 		for (int32 j = 0; j < scnt; ++j) {
-			auto document = Serialize::Document::readStickerFromStream(stickers.version, stickers.stream, info);
-			if (!_checkStreamStatus(stickers.stream)) {
+			auto document = Serialize::Document::readStickerFromStream(stickers.version, stream, info);
+			if (!_checkStreamStatus(stream)) {
 				return failed();
 			} else if (!document
 				|| !document->sticker()
@@ -3709,7 +3986,7 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 		}
 
 		qint32 datesCount = 0;
-		stickers.stream >> datesCount;
+		stream >> datesCount;
 		if (datesCount > 0) {
 			if (datesCount != scnt) {
 				return failed();
@@ -3722,7 +3999,7 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 			}
 			for (auto i = 0; i != datesCount; ++i) {
 				qint32 date = 0;
-				stickers.stream >> date;
+				stream >> date;
 				if (fillDates) {
 					set.dates.push_back(TimeId(date));
 				}
@@ -3730,19 +4007,19 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 		}
 
 		qint32 emojiCount = 0;
-		stickers.stream >> emojiCount;
-		if (!_checkStreamStatus(stickers.stream) || emojiCount < 0) {
+		stream >> emojiCount;
+		if (!_checkStreamStatus(stream) || emojiCount < 0) {
 			return failed();
 		}
 		for (int32 j = 0; j < emojiCount; ++j) {
 			QString emojiString;
 			qint32 stickersCount;
-			stickers.stream >> emojiString >> stickersCount;
+			stream >> emojiString >> stickersCount;
 			Stickers::Pack pack;
 			pack.reserve(stickersCount);
 			for (int32 k = 0; k < stickersCount; ++k) {
 				quint64 id;
-				stickers.stream >> id;
+				stream >> id;
 				const auto doc = Auth().data().document(id);
 				if (!doc->sticker()) continue;
 
@@ -3755,6 +4032,9 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 				}
 			}
 		}
+		if (!_checkStreamStatus(stream)) {
+			return failed();
+		}
 	}
 
 	// Read orders of installed and featured stickers.
@@ -5260,6 +5540,8 @@ Manager::Manager() {
 	connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 	_locationsWriteTimer.setSingleShot(true);
 	connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+	_maintenanceTimer.setSingleShot(true);
+	connect(&_maintenanceTimer, SIGNAL(timeout()), this, SLOT(maintenanceTimeout()));
 }
 
 void Manager::writeMap(bool fast) {
@@ -5294,7 +5576,106 @@ void Manager::locationsWriteTimeout() {
 	_writeLocations(WriteMapWhen::Now);
 }
 
+void Manager::scheduleMaintenance() {
+	if (!_maintenanceScheduled) {
+		_maintenanceScheduled = true;
+		_maintenanceTimer.start(kMaintenanceDelay);
+	}
+}
+
+void Manager::maintenanceTimeout() {
+	if (!_userWorking()) {
+		return;
+	} else if (!_maintenanceStarted) {
+		_maintenanceStarted = true;
+		crl::async([
+			=,
+			names = CollectGoodNames(),
+			basePath = _userBasePath
+		] {
+			auto paths = collectMaintenancePaths(names, basePath);
+			crl::on_main(this, [=, paths = std::move(paths)]() mutable {
+				LOG(("App Info: checking %1 local files in background."
+					).arg(paths.size()));
+				_maintenanceQueue = std::move(paths);
+				if (!_maintenanceQueue.empty()) {
+					_maintenanceTimer.start(kMaintenanceStepTimeout);
+				}
+			});
+		});
+		return;
+	}
+	if (_maintenanceQueue.empty()) {
+		return;
+	}
+	const auto count = std::min(
+		int(_maintenanceQueue.size()),
+		kMaintenanceFilesPerStep);
+	auto paths = std::vector<QString>(
+		end(_maintenanceQueue) - count,
+		end(_maintenanceQueue));
+	_maintenanceQueue.erase(end(_maintenanceQueue) - count, end(_maintenanceQueue));
+
+	crl::async([=, paths = std::move(paths)]() mutable {
+		auto bad = std::vector<QString>();
+		for (const auto &path : paths) {
+			if (!checkFileSignature(path)) {
+				bad.push_back(path);
+			}
+		}
+		crl::on_main(this, [=, bad = std::move(bad)] {
+			for (const auto &path : bad) {
+				// The file could be rewritten while we were checking it.
+				if (_userWorking() && !checkFileSignature(path)) {
+					LOG(("App Warning: removing corrupted local file '%1'."
+						).arg(path));
+					QFile::remove(path);
+				}
+			}
+			if (!_maintenanceQueue.empty()) {
+				_maintenanceTimer.start(kMaintenanceStepTimeout);
+			}
+		});
+	});
+}
+
+std::vector<QString> Manager::collectMaintenancePaths(
+		const base::flat_set<QString> &names,
+		const QString &basePath) {
+	// Files that are not referenced from the map at all are removed by
+	// Storage::ClearLegacyFiles() right after the map is read.
+	auto result = std::vector<QString>();
+	for (const auto &name : names) {
+		if (name.startsWith(qstr("map"))) {
+			continue;
+		}
+		const auto path = basePath + name;
+		if (!QFileInfo(path).exists()) {
+			continue;
+		}
+		const auto postfix = name[name.size() - 1];
+		if (postfix != 's') {
+			auto modern = path;
+			modern[modern.size() - 1] = 's';
+			if (QFileInfo(modern).exists()) {
+				// Legacy copies are never read when the safe one exists
+				// and FileWriteDescriptor::finish() removes them itself.
+				continue;
+			}
+		}
+		result.push_back(path);
+	}
+	return result;
+}
+
+bool Manager::checkFileSignature(const QString &path) {
+	auto data = QByteArray();
+	auto version = qint32();
+	return ReadSignedFile(path, path, data, version);
+}
+
 void Manager::finish() {
+	_maintenanceTimer.stop();
 	if (_mapWriteTimer.isActive()) {
 		mapWriteTimeout();
 	}
@@ -54,8 +54,10 @@ QString readAutoupdatePrefix();
 
 void reset();
 
-bool checkPasscode(const QByteArray &passcode);
-void setPasscode(const QByteArray &passcode);
+void checkPasscodeAsync(
+	const QByteArray &passcode,
+	FnMut<void(bool)> done);
+void setPasscodeAsync(const QByteArray &passcode, FnMut<void()> done);
 
 enum ClearManagerTask {
 	ClearManagerAll = 0xFFFF,
@@ -94,6 +96,7 @@ enum ReadMapState {
 	ReadMapPassNeeded = 2,
 };
 ReadMapState readMap(const QByteArray &pass);
+void readMapAsync(const QByteArray &pass, FnMut<void(ReadMapState)> done);
 int32 oldMapVersion();
 
 int32 oldSettingsVersion();
@@ -196,15 +199,27 @@ public:
 	void writingMap();
 	void writeLocations(bool fast);
 	void writingLocations();
+	void scheduleMaintenance();
 	void finish();
 
 public slots:
 	void mapWriteTimeout();
 	void locationsWriteTimeout();
+	void maintenanceTimeout();
 
 private:
+	// May be called from any thread, doesn't touch the global state.
+	[[nodiscard]] static std::vector<QString> collectMaintenancePaths(
+		const base::flat_set<QString> &names,
+		const QString &basePath);
+	[[nodiscard]] static bool checkFileSignature(const QString &path);
+
 	QTimer _mapWriteTimer;
 	QTimer _locationsWriteTimer;
+	QTimer _maintenanceTimer;
+	std::vector<QString> _maintenanceQueue;
+	bool _maintenanceScheduled = false;
+	bool _maintenanceStarted = false;
 
 };
 
@@ -135,7 +135,9 @@ void PasscodeLockWidget::paintContent(Painter &p) {
 }
 
 void PasscodeLockWidget::submit() {
-	if (_passcode->text().isEmpty()) {
+	if (_checking) {
+		return;
+	} else if (_passcode->text().isEmpty()) {
 		_passcode->showError();
 		return;
 	}
@@ -146,10 +148,23 @@ void PasscodeLockWidget::submit() {
 		return;
 	}
 
+	// Key derivation is slow by design, so it is done in background.
+	_checking = true;
 	const auto passcode = _passcode->text().toUtf8();
-	const auto correct = window()->account().sessionExists()
-		? Local::checkPasscode(passcode)
-		: (Local::readMap(passcode) != Local::ReadMapPassNeeded);
+	const auto done = crl::guard(this, [=](bool correct) {
+		_checking = false;
+		checked(correct);
+	});
+	if (window()->account().sessionExists()) {
+		Local::checkPasscodeAsync(passcode, done);
+	} else {
+		Local::readMapAsync(passcode, [=](Local::ReadMapState state) {
+			done(state != Local::ReadMapPassNeeded);
+		});
+	}
+}
+
+void PasscodeLockWidget::checked(bool correct) {
 	if (!correct) {
 		cSetPasscodeBadTries(cPasscodeBadTries() + 1);
 		cSetPasscodeLastTry(crl::now());